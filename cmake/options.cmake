@@ -18,3 +18,10 @@ if(WIN32)
 endif()
 
 add_definitions(-DDETAILED_STATS=1) # if 1, print detailed times
+
+# if ON, build optional pcre2 regex engine, needs libs/pcre2 from scripts/build_pcre2.sh
+option(WITH_PCRE2 "Build pcre2 regex engine" OFF)
+
+if(WITH_PCRE2)
+    add_definitions(-DWITH_PCRE2=1)
+endif()
@@ -0,0 +1,18 @@
+set(PCRE2_DIR "${MAIN_DIR}/libs/pcre2")
+set(PCRE2_LIB_DIR "${PCRE2_DIR}/lib/${PLATFORM}/${COMPILE_MODE}")
+
+target_include_directories(${PROJECT} PRIVATE "${PCRE2_DIR}/include")
+target_link_directories(${PROJECT} PRIVATE "${PCRE2_LIB_DIR}")
+
+message("PCRE2_LIB_DIR : ${PCRE2_LIB_DIR}")
+
+add_definitions(-DPCRE2_STATIC)
+add_definitions(-DPCRE2_CODE_UNIT_WIDTH=8)
+
+if(UNIX)
+    target_link_libraries(${PROJECT} LINK_PRIVATE "${PCRE2_LIB_DIR}/libpcre2-8.a")
+endif()
+
+if(WIN32)
+    target_link_libraries(${PROJECT} LINK_PRIVATE "${PCRE2_LIB_DIR}/pcre2-8-static.lib")
+endif()
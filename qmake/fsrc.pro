@@ -6,6 +6,8 @@ INCLUDEPATH += $${SRC_DIR}
 SOURCES += $${SRC_DIR}/fsrc.cpp
 
 HEADERS += $${SRC_DIR}/types.hpp
+HEADERS += $${SRC_DIR}/linescanner.hpp
+HEADERS += $${SRC_DIR}/query.hpp
 
 HEADERS += $${SRC_DIR}/utils.hpp
 SOURCES += $${SRC_DIR}/utils.cpp
@@ -22,6 +24,19 @@ SOURCES += $${SRC_DIR}/searchoptions.cpp
 HEADERS += $${SRC_DIR}/globmatcher.hpp
 SOURCES += $${SRC_DIR}/globmatcher.cpp
 
+SOURCES += $${SRC_DIR}/query.cpp
+
+HEADERS += $${SRC_DIR}/trigramindex.hpp
+SOURCES += $${SRC_DIR}/trigramindex.cpp
+HEADERS += $${SRC_DIR}/fingerprints.hpp
+SOURCES += $${SRC_DIR}/fingerprints.cpp
+HEADERS += $${SRC_DIR}/metadatacache.hpp
+SOURCES += $${SRC_DIR}/metadatacache.cpp
+HEADERS += $${SRC_DIR}/server.hpp
+SOURCES += $${SRC_DIR}/server.cpp
+HEADERS += $${SRC_DIR}/session.hpp
+SOURCES += $${SRC_DIR}/session.cpp
+
 HEADERS += $${SRC_DIR}/stopwatch.hpp
 
 HEADERS += $${SRC_DIR}/exitqueue.hpp
@@ -32,12 +47,20 @@ HEADERS += $${SRC_DIR}/printer/printer.hpp
 HEADERS += $${SRC_DIR}/printer/prettyprinter.hpp
 HEADERS += $${SRC_DIR}/printer/htmlprinter.hpp
 HEADERS += $${SRC_DIR}/printer/pipedprinter.hpp
+HEADERS += $${SRC_DIR}/printer/hexprinter.hpp
+HEADERS += $${SRC_DIR}/printer/streamprinter.hpp
 HEADERS += $${SRC_DIR}/printer/printerfactory.hpp
 
 HEADERS += $${SRC_DIR}/searcher/searcher.hpp
 HEADERS += $${SRC_DIR}/searcher/casesensitivesearcher.hpp
 HEADERS += $${SRC_DIR}/searcher/caseinsensitivesearcher.hpp
 HEADERS += $${SRC_DIR}/searcher/regexsearcher.hpp
+HEADERS += $${SRC_DIR}/searcher/pcre2searcher.hpp
+HEADERS += $${SRC_DIR}/searcher/bitapsearcher.hpp
+HEADERS += $${SRC_DIR}/searcher/fuzzysearcher.hpp
+HEADERS += $${SRC_DIR}/searcher/unicodesearcher.hpp
+HEADERS += $${SRC_DIR}/searcher/kernelsearcher.hpp
+HEADERS += $${SRC_DIR}/searcher/querysearcher.hpp
 HEADERS += $${SRC_DIR}/searcher/searcherfactory.hpp
 
 macx:   SOURCES += $${SRC_DIR}/macutils.mm
@@ -45,6 +68,16 @@ macx:   SOURCES += $${SRC_DIR}/macutils.mm
 # via https://mischasan.wordpress.com/2011/07/16/convergence-sse2-and-strstr/
 HEADERS += $${SRC_DIR}/mischasan.hpp
 
+# via Navarro, Raffinot: Flexible Pattern Matching in Strings
+HEADERS += $${SRC_DIR}/bitap.hpp
+
+# via Myers: A fast bit-vector algorithm for approximate string matching
+HEADERS += $${SRC_DIR}/myers.hpp
+
+# via https://www.unicode.org/Public/UCD/latest/ucd/CaseFolding.txt
+HEADERS += $${SRC_DIR}/utf8.hpp
+HEADERS += $${SRC_DIR}/utf16.hpp
+
 # via https://github.com/gcc-mirror/gcc/blob/master/libstdc%2B%2B-v3/include/bits/basic_string.tcc#L1199
 HEADERS += $${SRC_DIR}/stdstr.hpp
 
@@ -58,3 +91,4 @@ win32: include( win.pri )
 macx:  include( mac.pri )
 
 include( boost.pri )
+equals( WITH_PCRE2, 1 ): include( pcre2.pri )
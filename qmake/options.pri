@@ -16,3 +16,7 @@ linux: DEFINES += 'FIND_ALGO=FIND_STRSTR'
 win32: DEFINES += 'FIND_ALGO=FIND_STRSTR'
 
 DEFINES += 'DETAILED_STATS=1'       # if 1, print detailed times
+
+# if 1, build optional pcre2 regex engine, needs libs/pcre2 from scripts/build_pcre2.sh
+WITH_PCRE2 = 0
+DEFINES += 'WITH_PCRE2=$${WITH_PCRE2}'
@@ -0,0 +1,15 @@
+LIB_DIR=$${MAIN_DIR}/libs
+PCRE2_LIB_DIR=$${LIB_DIR}/pcre2/lib/$${PLATFORM}/$${COMPILE_MODE}
+INCLUDEPATH += $${LIB_DIR}/pcre2/include
+
+DEFINES += PCRE2_STATIC
+DEFINES += PCRE2_CODE_UNIT_WIDTH=8
+
+unix {
+    LIBS += $${PCRE2_LIB_DIR}/libpcre2-8.a
+}
+
+win32 {
+    QMAKE_LFLAGS += /LIBPATH:$${PCRE2_LIB_DIR}
+    LIBS += pcre2-8-static.lib
+}
@@ -0,0 +1,110 @@
+#!/usr/bin/env bash
+
+case $(uname) in
+    Linux)
+        OS=linux
+        ;;
+    Darwin)
+        OS=mac
+        ;;
+    CYGWIN*)
+        OS=win
+        ;;
+    *)
+        echo "Unknown OS" && exit 1
+        ;;
+esac
+
+PROJECT=pcre2
+VERSION="10.42"
+DL_URL="https://github.com/PCRE2Project/pcre2/releases/download/${PROJECT}-${VERSION}/${PROJECT}-${VERSION}.tar.gz"
+
+# static 8 bit library with JIT
+CMAKE_OPTIONS="-DPCRE2_SUPPORT_JIT=ON -DPCRE2_BUILD_PCRE2_8=ON -DPCRE2_BUILD_PCRE2_16=OFF -DPCRE2_BUILD_PCRE2_32=OFF -DPCRE2_BUILD_PCRE2GREP=OFF -DPCRE2_BUILD_TESTS=OFF -DBUILD_SHARED_LIBS=OFF -DCMAKE_DEBUG_POSTFIX="
+
+SCRIPT_DIR=$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )
+MAIN_DIR="$SCRIPT_DIR/.."
+TARGET_DIR="$MAIN_DIR/libs/$PROJECT"
+PROJECT_DIR="$MAIN_DIR/tmp/$PROJECT"
+DOWNLOAD="$PROJECT_DIR/$PROJECT-$VERSION.tar.gz"
+SRC_DIR="$PROJECT_DIR/src"
+BUILD_DIR="$SRC_DIR/${PROJECT}-${VERSION}"
+
+function indent {
+    sed  's/^/     /'
+}
+
+function doPrepare {
+    if [ -d "$SRC_DIR" ]; then
+        rm -rf "$SRC_DIR"
+    fi
+    if [ -d "$TARGET_DIR" ]; then
+        rm -rf "$TARGET_DIR"
+    fi
+    mkdir -p "$PROJECT_DIR"
+    mkdir -p "$SRC_DIR"
+}
+
+function doDownload {
+    if [ ! -f "$DOWNLOAD" ]; then
+        curl -s -L "$DL_URL" -o "$DOWNLOAD" 2>&1
+    fi
+}
+
+function doUnzip {
+    tar xzf "$DOWNLOAD" -C "$SRC_DIR"
+}
+
+function doBuild {
+    cd "$BUILD_DIR"
+
+    # debug
+    cmake -S . -B build_debug -DCMAKE_BUILD_TYPE=Debug \
+        -DCMAKE_MSVC_RUNTIME_LIBRARY="MultiThreadedDebug" \
+        $CMAKE_OPTIONS
+    cmake --build build_debug --config Debug --parallel
+
+    # release
+    cmake -S . -B build_release -DCMAKE_BUILD_TYPE=Release \
+        -DCMAKE_MSVC_RUNTIME_LIBRARY="MultiThreaded" \
+        $CMAKE_OPTIONS
+    cmake --build build_release --config Release --parallel
+}
+
+function macBuild {
+    export CFLAGS="-mmacosx-version-min=10.13"
+    doBuild
+}
+
+function winBuild {
+    doBuild
+}
+
+function linuxBuild {
+    doBuild
+}
+
+function doCopy {
+    mkdir -p "$TARGET_DIR/lib/$OS/debug"
+    mkdir -p "$TARGET_DIR/lib/$OS/release"
+    mkdir -p "$TARGET_DIR/include"
+    find "$BUILD_DIR/build_debug" -maxdepth 2 \( -name "libpcre2-8*.a" -o -name "pcre2-8*.lib" \) -exec cp {} "$TARGET_DIR/lib/$OS/debug/" \;
+    find "$BUILD_DIR/build_release" -maxdepth 2 \( -name "libpcre2-8*.a" -o -name "pcre2-8*.lib" \) -exec cp {} "$TARGET_DIR/lib/$OS/release/" \;
+    cp "$BUILD_DIR/build_release/pcre2.h" "$TARGET_DIR/include/"
+}
+
+
+echo "Prepare"
+doPrepare | indent
+
+echo "Download"
+doDownload | indent
+
+echo "Unzip"
+doUnzip | indent
+
+echo "Build"
+"${OS}Build" 2>&1 | indent
+
+echo "Copy"
+doCopy | indent
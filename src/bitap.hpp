@@ -0,0 +1,390 @@
+#pragma once
+
+#include <cctype>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <bitset>
+#include <algorithm>
+#include <limits>
+#include <functional>
+#include <emmintrin.h>
+
+#include "winutils.hpp"
+
+//! bit parallel Shift-And (bitap) search for regexes made of bytes, [classes] and '?'
+//! \sa Navarro, Raffinot: Flexible Pattern Matching in Strings, 4.3 Extended strings
+namespace bitap {
+
+using Mask = uint64_t;
+using Class = std::bitset<256>;
+
+//! bit 0 is the always active start state, so 63 positions are left
+constexpr size_t MAX_POSITIONS = 63;
+
+struct Pattern {
+    Mask masks[256] = {}; // bit i is set, if byte matches position i
+    Mask optional = 0;    // positions marked with '?'
+    Mask initial = 0;     // position before each block of optional positions
+    Mask final = 0;       // last position of each block of optional positions
+    Mask accept = 0;      // last position
+    size_t minSize = 0;   // shortest match
+    size_t maxSize = 0;   // longest match
+    int anchor = -1;      // mandatory position with one or two bytes to skip to, or -1
+    unsigned char anchorBytes[2] = {};
+
+    //! follows the epsilon transitions over optional positions
+    inline Mask closure( const Mask state ) const {
+        const Mask withFinal = state | final;
+        return state | ( optional & ( ~( withFinal - initial ) ^ withFinal ) );
+    }
+};
+
+namespace {
+
+inline void addCase( Class& cls ) {
+    for( int c = 'a'; c <= 'z'; ++c ) {
+        if( cls[c] || cls[c - 'a' + 'A'] ) {
+            cls.set( c );
+            cls.set( c - 'a' + 'A' );
+        }
+    }
+}
+
+//! \returns rough frequency of c in source code, higher is more frequent
+inline size_t frequency( const unsigned char c ) {
+    static const std::string_view common = "zqjxkvbywgpfmucdlhrsnioate ";
+    const size_t pos = common.find( static_cast<char>( tolower( c ) ) );
+    return pos == std::string_view::npos ? 0 : pos + 1;
+}
+
+inline Class rangeClass( const int from, const int to ) {
+    Class cls;
+
+    for( int c = from; c <= to; ++c ) { cls.set( c ); }
+
+    return cls;
+}
+
+//! parses escape sequence after '\'
+//! \returns false, if escape needs a full regex engine, e.g. \b or \x41
+inline bool parseEscape( const unsigned char c, Class& cls ) {
+    switch( c ) {
+        case 't': cls.set( '\t' ); return true;
+
+        case 'n': cls.set( '\n' ); return true;
+
+        case 'r': cls.set( '\r' ); return true;
+
+        case 'f': cls.set( '\f' ); return true;
+
+        case 'v': cls.set( '\v' ); return true;
+
+        case 'd': cls |= rangeClass( '0', '9' ); return true;
+
+        case 'D': cls |= ~rangeClass( '0', '9' ); return true;
+
+        case 's': cls |= Class().set( ' ' ).set( '\t' ).set( '\n' ).set( '\r' ).set( '\f' ).set( '\v' ); return true;
+
+        case 'S': cls |= ~Class().set( ' ' ).set( '\t' ).set( '\n' ).set( '\r' ).set( '\f' ).set( '\v' ); return true;
+
+        case 'w': cls |= rangeClass( 'a', 'z' ) | rangeClass( 'A', 'Z' ) | rangeClass( '0', '9' ) | Class().set( '_' ); return true;
+
+        case 'W': cls |= ~( rangeClass( 'a', 'z' ) | rangeClass( 'A', 'Z' ) | rangeClass( '0', '9' ) | Class().set( '_' ) ); return true;
+    }
+
+    // escaped punctuation is literal, except boost's word and buffer anchors
+    if( c < 128 && ispunct( c ) && !strchr( "<>`'", c ) ) {
+        cls.set( c );
+        return true;
+    }
+
+    return false;
+}
+
+//! parses [class] starting after '['
+//! \returns false, if class needs a full regex engine, e.g. [[:alpha:]]
+inline bool parseClass( const std::string& regex, size_t& pos, const bool ignoreCase, Class& cls ) {
+    bool negate = false;
+
+    if( pos < regex.size() && regex[pos] == '^' ) {
+        negate = true;
+        ++pos;
+    }
+
+    bool first = true;
+
+    while( pos < regex.size() ) {
+        unsigned char c = regex[pos++];
+
+        // ']' as first char is literal
+        if( c == ']' && !first ) {
+            // fold case before negation, so [^a] excludes 'A', too
+            if( ignoreCase ) { addCase( cls ); }
+
+            if( negate ) { cls = ~cls; }
+
+            return true;
+        }
+
+        first = false;
+
+        if( c == '[' ) { return false; }
+
+        if( c == '\\' ) {
+            if( pos == regex.size() ) { return false; }
+
+            unsigned char e = regex[pos++];
+
+            // only simple escapes in ranges
+            if( !parseEscape( e, cls ) ) { return false; }
+
+            continue;
+        }
+
+        // range, '-' as last char is literal
+        if( pos + 1 < regex.size() && regex[pos] == '-' && regex[pos + 1] != ']' ) {
+            unsigned char to = regex[pos + 1];
+
+            if( to == '\\' || to == '[' || to < c ) { return false; }
+
+            cls |= rangeClass( c, to );
+            pos += 2;
+            continue;
+        }
+
+        cls.set( c );
+    }
+
+    // unterminated class
+    return false;
+}
+
+}
+
+//! compiles literal bytes, escapes, [classes] and '?' into pattern
+//! \returns false, if regex needs a full regex engine
+inline bool compile( const std::string& regex, const bool ignoreCase, Pattern& pattern ) {
+    pattern = Pattern();
+    std::vector<Class> classes;
+    std::vector<bool> optionals;
+
+    size_t pos = 0;
+
+    while( pos < regex.size() ) {
+        unsigned char c = regex[pos++];
+        Class cls;
+
+        switch( c ) {
+            case '.':
+            case '^':
+            case '$':
+            case '|':
+            case '(':
+            case ')':
+            case '*':
+            case '+':
+            case '{':
+            case '}':
+                return false;
+
+            case '?':
+                // '?' needs a preceding position and lazy '??' is not supported
+                if( classes.empty() || optionals.back() ) { return false; }
+
+                optionals.back() = true;
+                continue;
+
+            case '[':
+                if( !parseClass( regex, pos, ignoreCase, cls ) ) { return false; }
+
+                break;
+
+            case '\\':
+                if( pos == regex.size() || !parseEscape( regex[pos++], cls ) ) { return false; }
+
+                break;
+
+            default:
+                cls.set( c );
+        }
+
+        if( ignoreCase ) { addCase( cls ); }
+
+        if( cls.none() || classes.size() == MAX_POSITIONS ) { return false; }
+
+        classes.push_back( cls );
+        optionals.push_back( false );
+    }
+
+    const size_t size = classes.size();
+
+    // empty matches are handled by the full regex engines
+    if( std::find( optionals.cbegin(), optionals.cend(), false ) == optionals.cend() ) { return false; }
+
+    // start state matches every byte
+    for( Mask& mask : pattern.masks ) { mask = 1; }
+
+    for( size_t i = 0; i < size; ++i ) {
+        const Mask bit = Mask( 1 ) << ( i + 1 );
+
+        for( int c = 0; c < 256; ++c ) {
+            if( classes[i][c] ) { pattern.masks[c] |= bit; }
+        }
+
+        if( optionals[i] ) {
+            pattern.optional |= bit;
+
+            if( i == 0 || !optionals[i - 1] ) { pattern.initial |= bit >> 1; }
+
+            if( i + 1 == size || !optionals[i + 1] ) { pattern.final |= bit; }
+        } else {
+            pattern.minSize++;
+        }
+    }
+
+    pattern.maxSize = size;
+    pattern.accept = Mask( 1 ) << size;
+
+    // anchor at the rarest mandatory position with max two bytes before any optional one
+    size_t rarest = std::numeric_limits<size_t>::max();
+
+    for( size_t i = 0; i < size && !optionals[i]; ++i ) {
+        if( classes[i].count() > 2 ) { continue; }
+
+        size_t score = classes[i].count();
+
+        for( int c = 0; c < 256; ++c ) {
+            if( classes[i][c] ) { score += frequency( c ); }
+        }
+
+        if( score < rarest ) {
+            rarest = score;
+            pattern.anchor = static_cast<int>( i );
+        }
+    }
+
+    if( pattern.anchor != -1 ) {
+        size_t found = 0;
+
+        for( int c = 0; c < 256; ++c ) {
+            if( classes[pattern.anchor][c] ) { pattern.anchorBytes[found++] = c; }
+        }
+
+        // single byte
+        if( found == 1 ) { pattern.anchorBytes[1] = pattern.anchorBytes[0]; }
+    }
+
+    return true;
+}
+
+namespace {
+
+//! \returns first occurrence of a or b
+inline const unsigned char* find2( const unsigned char* data, const size_t size, const unsigned char a, const unsigned char b ) {
+    if( a == b ) { return static_cast<const unsigned char*>( memchr( data, a, size ) ); }
+
+    const __m128i first  = _mm_set1_epi8( a );
+    const __m128i second = _mm_set1_epi8( b );
+    size_t pos = 0;
+
+    for( ; pos + sizeof( __m128i ) <= size; pos += sizeof( __m128i ) ) {
+        const __m128i text16 = _mm_loadu_si128( ( __m128i const* )( data + pos ) );
+        const int mask = _mm_movemask_epi8( _mm_or_si128( _mm_cmpeq_epi8( text16, first ), _mm_cmpeq_epi8( text16, second ) ) );
+
+        if( mask ) { return data + pos + ffs( mask ) - 1; }
+    }
+
+    for( ; pos < size; ++pos ) {
+        if( data[pos] == a || data[pos] == b ) { return data + pos; }
+    }
+
+    return nullptr;
+}
+
+template<bool Optional>
+inline Mask step( const Pattern& pattern, const Mask state ) {
+    if constexpr( Optional ) {
+        return pattern.closure( state );
+    } else {
+        return state;
+    }
+}
+
+template<bool Optional>
+inline void find( const std::string_view& text, const Pattern& pattern, const std::function<bool( size_t from, size_t to )>& onMatch ) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>( text.data() );
+    const size_t size = text.size();
+    const Mask start = step<Optional>( pattern, 1 );
+    const size_t anchor = pattern.anchor;
+
+    size_t from = 0; // no match may start before from
+    size_t pos = 0;
+    Mask state = start;
+
+    while( pos < size ) {
+        // skip to next anchor, if no position is active
+        if( state == start && pattern.anchor != -1 ) {
+            if( pos + anchor >= size ) { return; }
+
+            const unsigned char* next = find2( data + pos + anchor, size - pos - anchor, pattern.anchorBytes[0], pattern.anchorBytes[1] );
+
+            if( !next ) { return; }
+
+            pos = next - data - anchor;
+        }
+
+        state = step<Optional>( pattern, ( ( state << 1 ) | 1 ) & pattern.masks[data[pos++]] );
+
+        if( !( state & pattern.accept ) ) { continue; }
+
+        // end found, fixed size patterns know their start
+        if constexpr( !Optional ) {
+            if( !onMatch( pos - pattern.maxSize, pos ) ) { return; }
+
+            from = pos;
+            state = start;
+            continue;
+        }
+
+        // else find leftmost start and the longest match from there
+        size_t candidate = pos > from + pattern.maxSize ? pos - pattern.maxSize : from;
+        size_t last = pos - pattern.minSize;
+
+        for( ; candidate <= last; ++candidate ) {
+            Mask anchored = start;
+            size_t end = 0;
+
+            for( size_t i = candidate; anchored && i < size && i - candidate < pattern.maxSize; ) {
+                anchored = step<Optional>( pattern, ( anchored << 1 ) & pattern.masks[data[i++]] );
+
+                if( anchored & pattern.accept ) { end = i; }
+            }
+
+            if( end ) {
+                if( !onMatch( candidate, end ) ) { return; }
+
+                from = end;
+                break;
+            }
+        }
+
+        pos = from;
+        state = start;
+    }
+}
+
+}
+
+//! calls onMatch for all leftmost, non overlapping matches with greedy '?', until it returns false
+inline void find( const std::string_view& text, const Pattern& pattern, const std::function<bool( size_t from, size_t to )>& onMatch ) {
+    if( pattern.optional ) {
+        find<true>( text, pattern, onMatch );
+    } else {
+        find<false>( text, pattern, onMatch );
+    }
+}
+
+}
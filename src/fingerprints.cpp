@@ -0,0 +1,164 @@
+#include "fingerprints.hpp"
+
+#include <fstream>
+
+#include "searchoptions.hpp"
+
+void fingerprint::Cache::setup( const SearchOptions& opts ) {
+    if( !opts.fingerprints || opts.binary ) { return; }
+
+    location = trigram::location( opts.path, "fsrc.bloom" );
+    root = opts.path.native();
+    enabled = true;
+
+    const std::string literal = trigram::literal( opts );
+
+    if( !literal.empty() ) {
+        needed = trigram::trigrams( literal );
+        active = true;
+    }
+
+    size_t size = 0;
+    const char* data = trigram::map( location, mapping, size );
+
+    if( !data || size < sizeof( Header ) ) { return; }
+
+    header = reinterpret_cast<const Header*>( data );
+
+    if( memcmp( header->magic, MAGIC, sizeof( MAGIC ) ) || header->version != VERSION || header->size != size ) {
+        header = nullptr;
+        return;
+    }
+
+    files = reinterpret_cast<const File*>( data + header->filesOffset );
+    paths = data + header->pathsOffset;
+    bits = reinterpret_cast<const uint64_t*>( data + header->bitsOffset );
+    seen.reset( new std::atomic_bool[header->files] );
+
+    ids.reserve( header->files );
+
+    for( uint32_t id = 0; id < header->files; ++id ) {
+        ids.emplace( std::string_view( paths + files[id].path ), id );
+        seen[id] = false;
+    }
+}
+
+fingerprint::Cache::Check fingerprint::Cache::check( const sys_string& path, const trigram::Stamp& stamp ) const {
+    if( !enabled ) { return Check::Search; }
+
+    auto found = ids.find( trigram::relativeKey( path, root ) );
+
+    if( found == ids.end() ) { return Check::Update; }
+
+    const uint32_t id = found->second;
+    const File& file = files[id];
+    seen[id] = true;
+
+    if( file.stamp != stamp ) { return Check::Update; }
+
+    if( !active || ( file.flags & trigram::File::Always ) ) { return Check::Search; }
+
+    for( const uint32_t trigram : needed ) {
+        if( !contains( bits + file.bits, file.words, trigram ) ) { return Check::Skip; }
+    }
+
+    return Check::Search;
+}
+
+void fingerprint::Cache::see( const sys_string& path ) const {
+    if( !header ) { return; }
+
+    auto found = ids.find( trigram::relativeKey( path, root ) );
+
+    if( found != ids.end() ) { seen[found->second] = true; }
+}
+
+void fingerprint::Cache::add( const sys_string& path, const trigram::Stamp& stamp, const utils::FileView& view ) {
+    // binaries and unreadable files have no content
+    if( !view.size && stamp.size ) { return; }
+
+    Update update;
+    update.path = trigram::relativeKey( path, root );
+    update.stamp = stamp;
+
+    if( view.encoding != utils::Encoding::Utf8 ) {
+        update.flags = trigram::File::Always;
+    } else {
+        static thread_local std::vector<uint32_t> trigrams;
+        trigram::collect( view.content, trigrams );
+
+        update.words.resize( words( trigrams.size() ), 0 );
+
+        for( const uint32_t trigram : trigrams ) { fingerprint::add( update.words.data(), update.words.size(), trigram ); }
+    }
+
+    std::unique_lock<std::mutex> lock( m );
+    updates.emplace_back( std::move( update ) );
+}
+
+bool fingerprint::Cache::save( const bool complete ) {
+    if( !enabled || updates.empty() ) { return true; }
+
+    std::vector<File> table;
+    std::string names;
+    std::vector<uint64_t> filters;
+
+    auto append = [&table, &names, &filters]( const std::string_view & path, const uint32_t flags, const trigram::Stamp & stamp, const uint64_t* words, const uint32_t count ) {
+        File& file = table.emplace_back();
+        file.path = static_cast<uint32_t>( names.size() );
+        file.flags = flags;
+        file.words = count;
+        file.stamp = stamp;
+        file.bits = filters.size();
+        names += path;
+        names += '\0';
+        filters.insert( filters.end(), words, words + count );
+    };
+
+    std::unordered_map<std::string_view, bool> updated;
+
+    for( const Update& update : updates ) {
+        append( update.path, update.flags, update.stamp, update.words.data(), static_cast<uint32_t>( update.words.size() ) );
+        updated[update.path] = true;
+    }
+
+    // keep unchanged fingerprints, and those of files, which a partial search didn't see
+    for( uint32_t id = 0; header && id < header->files; ++id ) {
+        const File& file = files[id];
+        const std::string_view path( paths + file.path );
+
+        if( updated.count( path ) || ( complete && !seen[id] ) ) { continue; }
+
+        append( path, file.flags, file.stamp, bits + file.bits, file.words );
+    }
+
+    names.resize( ( names.size() + 7 ) / 8 * 8, '\0' );
+
+    Header written;
+    memcpy( written.magic, MAGIC, sizeof( MAGIC ) );
+    written.files = static_cast<uint32_t>( table.size() );
+    written.filesOffset = sizeof( Header );
+    written.pathsOffset = written.filesOffset + table.size() * sizeof( File );
+    written.bitsOffset = written.pathsOffset + names.size();
+    written.size = written.bitsOffset + filters.size() * sizeof( uint64_t );
+
+    // write to a temporary file and rename, so searches never see half a cache
+    const fs::path temporary = location.native() + toSysString( ".tmp" );
+    std::ofstream out( temporary.native(), std::ios::binary );
+    out.write( reinterpret_cast<const char*>( &written ), sizeof( Header ) );
+    out.write( reinterpret_cast<const char*>( table.data() ), table.size() * sizeof( File ) );
+    out.write( names.data(), names.size() );
+    out.write( reinterpret_cast<const char*>( filters.data() ), filters.size() * sizeof( uint64_t ) );
+    out.close();
+
+    boost::system::error_code error;
+
+    if( out ) { fs::rename( temporary, location, error ); }
+
+    if( !out || error ) {
+        LOG( "Error  : could not write " << location.string() );
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <memory>
+
+#include "trigramindex.hpp"
+
+//! sidecar cache with a Bloom filter of trigrams per file, a lighter alternative to the trigram index
+//! searches with --fingerprints skip unchanged files w/out the term's trigrams before opening them,
+//! and record the fingerprints of new and changed files, which they read anyway
+namespace fingerprint {
+
+constexpr char MAGIC[8] = "FSRCBLM";
+constexpr uint32_t VERSION = 2;   // 2 mixes the hash
+constexpr int PROBES = 3;              // bits per trigram
+constexpr uint32_t MAX_WORDS = 16384;  // 128 kB per file, larger files saturate
+
+struct Header {
+    char magic[8] = {};
+    uint32_t version = VERSION;
+    uint32_t files = 0;         // entries in file table
+    uint64_t filesOffset = 0;   // File[files]
+    uint64_t pathsOffset = 0;   // \0 terminated paths relative to the searched folder
+    uint64_t bitsOffset = 0;    // filters of all files as uint64_t words
+    uint64_t size = 0;          // of the whole cache
+};
+
+struct File {
+    uint32_t path = 0;          // offset into paths
+    uint32_t flags = 0;         // trigram::File::Always for UTF-16 files
+    uint32_t words = 0;         // filter size, a power of 2, 0 for empty files
+    uint32_t reserved = 0;
+    trigram::Stamp stamp;
+    uint64_t bits = 0;          // offset in words
+};
+
+//! \returns PROBES bit positions of 21 bits each
+//! \note mixed with splitmix64's finalizer, a plain multiplication leaves the low bits
+//!       of small filters depending on the low byte of the trigram only
+inline uint64_t hash( const uint32_t trigram ) {
+    uint64_t h = ( trigram + 1ull ) * 0x9e3779b97f4a7c15ull;
+    h = ( h ^ ( h >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+    h = ( h ^ ( h >> 27 ) ) * 0x94d049bb133111ebull;
+    return h ^ ( h >> 31 );
+}
+
+inline void add( uint64_t* words, const uint32_t count, const uint32_t trigram ) {
+    const uint64_t mask = count * 64ull - 1;
+    uint64_t h = hash( trigram );
+
+    for( int i = 0; i < PROBES; ++i, h >>= 21 ) {
+        const uint64_t bit = h & mask;
+        words[bit >> 6] |= 1ull << ( bit & 63 );
+    }
+}
+
+inline bool contains( const uint64_t* words, const uint32_t count, const uint32_t trigram ) {
+    if( !count ) { return false; }
+
+    const uint64_t mask = count * 64ull - 1;
+    uint64_t h = hash( trigram );
+
+    for( int i = 0; i < PROBES; ++i, h >>= 21 ) {
+        const uint64_t bit = h & mask;
+
+        if( !( words[bit >> 6] & ( 1ull << ( bit & 63 ) ) ) ) { return false; }
+    }
+
+    return true;
+}
+
+//! \returns filter size in words for n trigrams, with ~10 bits per trigram for ~1 % false positives
+inline uint32_t words( const size_t n ) {
+    uint32_t count = n ? 4 : 0;
+
+    while( count && count < MAX_WORDS && count * 64ull < 10 * n ) { count *= 2; }
+
+    return count;
+}
+
+struct Cache {
+    //! file was skipped, may match, or has no valid fingerprint and may match
+    enum class Check { Skip, Search, Update };
+
+    //! fingerprint of a file, which was read in this search
+    struct Update {
+        std::string path;
+        uint32_t flags = 0;
+        trigram::Stamp stamp;
+        std::vector<uint64_t> words;
+    };
+
+    std::shared_ptr<void> mapping;
+    const Header* header = nullptr;
+    const File* files = nullptr;
+    const char* paths = nullptr;
+    const uint64_t* bits = nullptr;
+    std::unordered_map<std::string_view, uint32_t> ids; // of relative paths
+    std::unique_ptr<std::atomic_bool[]> seen;           // files of this search, others were deleted
+
+    std::vector<uint32_t> needed; // trigrams of the term
+    sys_string root;              // prefix of absolute paths
+    fs::path location;
+    bool enabled = false;         // records fingerprints with --fingerprints
+    bool active = false;          // and skips files, if the term has trigrams
+
+    std::mutex m;
+    std::deque<Update> updates;
+
+    //! loads the cache with --fingerprints
+    void setup( const SearchOptions& opts );
+    //! \returns Skip, if path is unchanged since stamp and its fingerprint lacks a trigram of the term
+    Check check( const sys_string& path, const trigram::Stamp& stamp ) const;
+    //! keeps the fingerprint of path, which the search skipped before check
+    void see( const sys_string& path ) const;
+    //! records the fingerprint of the text file in view
+    void add( const sys_string& path, const trigram::Stamp& stamp, const utils::FileView& view );
+    //! writes loaded and new fingerprints, w/out those of deleted files, if the search saw all files
+    bool save( const bool complete );
+};
+
+}
@@ -3,14 +3,43 @@
 #include "searcher/searcherfactory.hpp"
 #include "stopwatch.hpp"
 #include "exitqueue.hpp"
+#include "trigramindex.hpp"
+#include "server.hpp"
+#include "session.hpp"
 
-int main( int argc, char* argv[] ) {
+//! searches opts.path, the daemon passes its warm thread pool and git file lists
+//! \returns exit code, EXIT_FAILURE for invalid regexes
+int runSearch( SearchOptions& opts, server::Warm* warm ) {
 
 #if DETAILED_STATS
     StopWatch total;
     total.start();
 #endif
 
+    std::function<Printer*()> makePrinter = printerfactory::printerFunc( opts );
+    std::function<Searcher*()> makeSearcher = searcherfactory::searcherFunc( opts );
+
+    if( !makeSearcher ) { return EXIT_FAILURE; }
+
+    SearchController searcher( opts, makeSearcher, makePrinter );
+
+    // set prefix for clickable paths
+    if( searcher.inGit() ) { opts.pathPrefix = utils::absolutePath( opts.path.native() ); }
+
+    searcher.run( warm );
+
+#if DETAILED_STATS
+    auto ms = total.stop() / 1000000;
+    searcher.printStats();
+    searcher.printFooter( ms );
+#endif
+
+    ExitQueue::call();
+    return EXIT_SUCCESS;
+}
+
+int main( int argc, char* argv[] ) {
+
     SearchOptions opts = SearchOptions::parseArgs( argc, argv );
 
     if( !opts ) { return EXIT_FAILURE; }
@@ -21,25 +50,24 @@ int main( int argc, char* argv[] ) {
         exit( -1 );
     }
 
-    std::function<Printer*()> makePrinter = printerfactory::printerFunc( opts );
-    std::function<Searcher*()> makeSearcher = searcherfactory::searcherFunc( opts );
-    SearchController searcher( opts, makeSearcher, makePrinter );
+    if( opts.buildIndex ) {
+        return trigram::build( opts ) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
-    if( !opts.noGit && fs::exists( opts.path / ".git" ) ) {
-        // set prefix for clickable paths
-        opts.pathPrefix = utils::absolutePath( opts.path.native() );
+    if( opts.daemon ) {
+        return server::serve( opts, runSearch ) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
-        searcher.onGitFiles();
-    } else {
-        searcher.onAllFiles();
+    if( opts.interactive ) {
+        session::interactive( opts, argc, argv, searcherfactory::searcherFunc );
+        return 0;
     }
 
-#if DETAILED_STATS
-    auto ms = total.stop() / 1000000;
-    searcher.printStats();
-    searcher.printFooter( ms );
-#endif
+    int status = EXIT_SUCCESS;
 
-    ExitQueue::call();
-    return 0;
+    if( !opts.noDaemon && server::forward( opts, argc, argv, status ) ) {
+        return status;
+    }
+
+    return runSearch( opts, nullptr );
 }
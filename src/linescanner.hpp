@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string_view>
+
+#include "types.hpp"
+#include "ssefind.hpp"
+
+namespace search {
+
+//! finds the lines of ascending matches while searching, w/out splitting the whole file into lines
+//! newlines between matches are counted with sse::count, the text behind the last line of a match is never scanned
+struct LineScanner {
+    const std::string_view& content;
+    Lines& lines;
+    size_t counted = 0; // newlines before counted are in number
+    size_t number = 1;
+
+    LineScanner( const std::string_view& content, Lines& lines ) : content( content ), lines( lines ) {
+        lines.clear();
+    }
+
+    //! adds the lines of a match [from, to), if they are not the lines of the previous match
+    inline void add( const size_t from, const size_t to ) {
+        // matches across newlines end at the line of their last char, or the next line, if that's a newline
+        const size_t last = to > from && content[to - 1] != '\n' ? to - 1 : to;
+
+        // a match starting at a newline continues the previous match's line
+        if( !lines.empty() && ( from < lines.back().end || ( to > from && from == lines.back().end ) ) ) {
+            if( last > lines.back().end ) {
+                lines.back().end = static_cast<Offset>( std::min( content.find( '\n', last ), content.size() ) );
+            }
+
+            return;
+        }
+
+        // an empty match at a newline belongs to the next line, a match of the newline to its own line
+        const size_t until = std::min( to > from ? from : from + 1, content.size() );
+        const size_t previous = lines.empty() ? 0 : lines.back().end;
+        number += sse::count( content.substr( counted, until - counted ), '\n' );
+        counted = until;
+
+        // line bounds are only searched within the lines of the match
+        const size_t newline = content.substr( previous, until - previous ).rfind( '\n' );
+        const size_t begin = newline == std::string_view::npos ? previous : previous + newline + 1;
+        const size_t end = std::min( content.find( '\n', std::max( begin, last ) ), content.size() );
+
+        lines.push_back( {static_cast<Offset>( number ), static_cast<Offset>( begin ), static_cast<Offset>( end )} );
+    }
+};
+
+}
@@ -0,0 +1,115 @@
+#include "metadatacache.hpp"
+
+#include <fstream>
+
+#include "searchoptions.hpp"
+
+void metadata::Cache::setup( const SearchOptions& opts ) {
+#ifdef _WIN32
+    // w/out inodes, files can't be identified by their stat
+    return;
+#endif
+
+    if( !opts.metadata ) { return; }
+
+    location = trigram::location( opts.path, "fsrc.meta" );
+    enabled = true;
+
+    size_t size = 0;
+    const char* data = trigram::map( location, mapping, size );
+
+    if( !data || size < sizeof( Header ) ) { return; }
+
+    header = reinterpret_cast<const Header*>( data );
+
+    if( memcmp( header->magic, MAGIC, sizeof( MAGIC ) ) || header->version != VERSION || header->size != size ||
+            size != sizeof( Header ) + header->files * sizeof( Entry ) ) {
+        header = nullptr;
+        return;
+    }
+
+    entries = reinterpret_cast<const Entry*>( data + sizeof( Header ) );
+    seen.reset( new std::atomic_bool[header->files] );
+
+    for( uint32_t i = 0; i < header->files; ++i ) { seen[i] = false; }
+}
+
+metadata::Kind metadata::Cache::kind( const uint64_t device, const trigram::Stamp& stamp ) const {
+    if( !header ) { return Kind::Unknown; }
+
+    Entry key;
+    key.device = device;
+    key.stamp.inode = stamp.inode;
+
+    const Entry* end = entries + header->files;
+    const Entry* found = std::lower_bound( entries, end, key );
+
+    if( found == end || found->device != device || found->stamp != stamp ) { return Kind::Unknown; }
+
+    seen[found - entries] = true;
+    return found->kind;
+}
+
+void metadata::Cache::add( const uint64_t device, const trigram::Stamp& stamp, const utils::FileView& view ) {
+    if( !enabled ) { return; }
+
+    Entry entry;
+    entry.device = device;
+    entry.stamp = stamp;
+
+    if( view.binary ) {
+        entry.kind = Kind::Binary;
+    } else if( view.size ) {
+        // --binary reads binaries, too
+        const std::string_view head = view.content.substr( 0, 300 );
+        entry.kind = view.encoding == utils::Encoding::Utf8 && utils::detectEncoding( head ) == utils::Encoding::Utf8 &&
+                     !utils::isTextFile( head ) ? Kind::Binary : Kind::Text;
+    } else {
+        return; // unreadable
+    }
+
+    std::unique_lock<std::mutex> lock( m );
+    updates.push_back( entry );
+}
+
+bool metadata::Cache::save( const bool complete ) {
+    if( !enabled ) { return true; }
+
+    std::vector<Entry> written = updates;
+
+    // keep unchanged entries, and those of files, which a partial search didn't see
+    for( uint32_t i = 0; header && i < header->files; ++i ) {
+        if( seen[i] || !complete ) { written.push_back( entries[i] ); }
+    }
+
+    if( header && written.size() == header->files && updates.empty() ) { return true; }
+
+    // updates come first and replace stale entries of the same file
+    std::stable_sort( written.begin(), written.end() );
+    written.erase( std::unique( written.begin(), written.end(), []( const Entry & a, const Entry & b ) {
+        return a.device == b.device && a.stamp.inode == b.stamp.inode;
+    } ), written.end() );
+
+    Header out;
+    memcpy( out.magic, MAGIC, sizeof( MAGIC ) );
+    out.files = static_cast<uint32_t>( written.size() );
+    out.size = sizeof( Header ) + written.size() * sizeof( Entry );
+
+    // write to a temporary file and rename, so searches never see half a cache
+    const fs::path temporary = location.native() + toSysString( ".tmp" );
+    std::ofstream file( temporary.native(), std::ios::binary );
+    file.write( reinterpret_cast<const char*>( &out ), sizeof( Header ) );
+    file.write( reinterpret_cast<const char*>( written.data() ), written.size() * sizeof( Entry ) );
+    file.close();
+
+    boost::system::error_code error;
+
+    if( file ) { fs::rename( temporary, location, error ); }
+
+    if( !file || error ) {
+        LOG( "Error  : could not write " << location.string() );
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <mutex>
+#include <memory>
+
+#include "trigramindex.hpp"
+
+//! persistent cache of file classifications keyed by device, inode, size and mtime
+//! searches with --metadata skip binaries, which an earlier search opened, after a stat w/out open and read
+//! empty files need no entry, their stat tells
+namespace metadata {
+
+constexpr char MAGIC[8] = "FSRCMET";
+constexpr uint32_t VERSION = 1;
+
+enum class Kind : uint32_t { Unknown, Text, Binary };
+
+struct Header {
+    char magic[8] = {};
+    uint32_t version = VERSION;
+    uint32_t files = 0;         // entries behind the header
+    uint64_t size = 0;          // of the whole cache
+};
+
+//! sorted by device and inode
+struct Entry {
+    uint64_t device = 0;
+    trigram::Stamp stamp;
+    Kind kind = Kind::Unknown;
+    uint32_t reserved = 0;
+
+    bool operator<( const Entry& that ) const {
+        return device != that.device ? device < that.device : stamp.inode < that.stamp.inode;
+    }
+};
+
+struct Cache {
+    std::shared_ptr<void> mapping;
+    const Header* header = nullptr;
+    const Entry* entries = nullptr;
+    std::unique_ptr<std::atomic_bool[]> seen; // entries of this search, others were deleted or changed
+    fs::path location;
+    bool enabled = false;
+
+    std::mutex m;
+    std::vector<Entry> updates;
+
+    //! loads the cache with --metadata
+    void setup( const SearchOptions& opts );
+    //! \returns kind of file, Unknown, if it's not cached or changed since
+    Kind kind( const uint64_t device, const trigram::Stamp& stamp ) const;
+    //! records the kind of the file in view
+    void add( const uint64_t device, const trigram::Stamp& stamp, const utils::FileView& view );
+    //! writes loaded and new entries, w/out those of deleted files, if the search saw all files
+    bool save( const bool complete );
+};
+
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <functional>
+
+//! bit parallel approximate search with max k edits (Levenshtein distance)
+//! \sa Myers: A fast bit-vector algorithm for approximate string matching based on dynamic programming
+//! \sa Hyyrö: Explaining and extending the bit-parallel approximate string matching algorithm of Myers
+namespace myers {
+
+using Mask = uint64_t;
+
+constexpr size_t MAX_SIZE = 64;
+
+struct Pattern {
+    Mask forward[256] = {};  // bit i is set, if byte matches term[i]
+    Mask backward[256] = {}; // bit i is set, if byte matches term[size - 1 - i]
+    size_t size = 0;
+};
+
+//! \returns false, if term is empty or longer than MAX_SIZE
+inline bool compile( const std::string& term, const bool ignoreCase, Pattern& pattern ) {
+    pattern = Pattern();
+    pattern.size = term.size();
+
+    if( term.empty() || term.size() > MAX_SIZE ) { return false; }
+
+    for( size_t i = 0; i < term.size(); ++i ) {
+        const unsigned char c = term[i];
+        const Mask forward = Mask( 1 ) << i;
+        const Mask backward = Mask( 1 ) << ( term.size() - 1 - i );
+
+        pattern.forward[c] |= forward;
+        pattern.backward[c] |= backward;
+
+        if( ignoreCase && isalpha( c ) ) {
+            pattern.forward[tolower( c )] |= forward;
+            pattern.forward[toupper( c )] |= forward;
+            pattern.backward[tolower( c )] |= backward;
+            pattern.backward[toupper( c )] |= backward;
+        }
+    }
+
+    return true;
+}
+
+namespace {
+
+//! one column of the edit distance matrix, encoded as vertical deltas
+struct Column {
+    Mask pv = ~Mask( 0 );
+    Mask mv = 0;
+    size_t score = 0;
+
+    //! \param anchored if true, the alignment must start at the first byte
+    inline void step( const Mask eq, const Mask last, const bool anchored ) {
+        const Mask xv = eq | mv;
+        const Mask xh = ( ( ( eq & pv ) + pv ) ^ pv ) | eq;
+        Mask ph = mv | ~( xh | pv );
+        Mask mh = pv & xh;
+
+        if( ph & last ) { ++score; }
+
+        if( mh & last ) { --score; }
+
+        ph = ( ph << 1 ) | ( anchored ? 1 : 0 );
+        mh = mh << 1;
+        pv = mh | ~( xv | ph );
+        mv = ph & xv;
+    }
+};
+
+}
+
+//! \returns start of the best alignment of pattern ending at end, which does not start before from
+inline size_t start( const std::string_view& text, const size_t end, const size_t from, const Pattern& pattern, const size_t errors ) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>( text.data() );
+    const Mask last = Mask( 1 ) << ( pattern.size - 1 );
+    const size_t longest = std::min( end - from, pattern.size + errors );
+
+    Column column;
+    column.score = pattern.size;
+
+    size_t best = end;
+    size_t bestScore = pattern.size;
+
+    // walk backwards from end and keep the closest start with the lowest distance
+    for( size_t length = 1; length <= longest; ++length ) {
+        column.step( pattern.backward[data[end - length]], last, true );
+
+        if( column.score < bestScore ) {
+            bestScore = column.score;
+            best = end - length;
+        }
+    }
+
+    return best;
+}
+
+//! calls onMatch for non overlapping matches with max errors edits in text[from, to)
+//! each match ends at the lowest distance of a run of ends within errors, stops if onMatch returns false
+inline void find( const std::string_view& text, const size_t from, const size_t to, const Pattern& pattern, const size_t errors,
+                  const std::function<bool( size_t from, size_t to )>& onMatch ) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>( text.data() );
+    const Mask last = Mask( 1 ) << ( pattern.size - 1 );
+
+    Column column;
+    column.score = pattern.size;
+
+    size_t begin = from;          // no match may start before begin
+    size_t bestEnd = 0;           // end of best match in current run, 0 if no run
+    size_t bestScore = errors + 1;
+
+    //! \returns false, if search should stop
+    auto report = [&] {
+        size_t matchStart = start( text, bestEnd, begin, pattern, errors );
+        const bool next = onMatch( matchStart, bestEnd );
+        begin = bestEnd;
+        bestEnd = 0;
+        bestScore = errors + 1;
+        return next;
+    };
+
+    for( size_t pos = from; pos < to; ++pos ) {
+        column.step( pattern.forward[data[pos]], last, false );
+
+        if( column.score <= errors ) {
+            if( column.score < bestScore ) {
+                bestScore = column.score;
+                bestEnd = pos + 1;
+            }
+        } else if( bestEnd ) {
+            if( !report() ) { return; }
+        }
+    }
+
+    if( bestEnd ) { report(); }
+}
+
+}
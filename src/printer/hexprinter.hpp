@@ -0,0 +1,89 @@
+#pragma once
+
+#include "prettyprinter.hpp"
+
+#define HEX_ROW 16
+
+//! prints matches of --binary as byte offsets with hex and ASCII dumps of their 16 byte rows
+//! piped, each row is prefixed with the path and has no colors
+struct HexPrinter : public PrettyPrinter {
+    HexPrinter( const SearchOptions& opts ) : PrettyPrinter( opts ) {}
+    virtual void collectPrints( const sys_string& path, const search::Matches& matches, const search::Lines& lines, const std::string_view& content ) override;
+    virtual ~HexPrinter() override {}
+
+    //! \returns last byte of match, empty matches mark their first byte
+    static inline size_t lastByte( const search::Match& match ) {
+        return match.to > match.from ? match.to - 1 : match.from;
+    }
+
+    //! prints row at offset, bytes of matches from first on in red
+    void row( const std::string_view& content, const size_t offset, const search::Matches& matches, const size_t first, const std::string& prefix );
+};
+
+void HexPrinter::collectPrints( const sys_string& path, const search::Matches& matches, const search::Lines&, const std::string_view& content ) {
+    prints.clear();
+
+    if( !opts.piped ) { this->filePath( path ); }
+
+    const std::string prefix = opts.piped ? std::string( path.cbegin(), path.cend() ) + ":" : "\n";
+    size_t next = 0;  // first row, which is not printed yet
+    size_t first = 0; // first match, which may be in the current row
+
+    for( const search::Match& match : matches ) {
+        const size_t last = std::min( lastByte( match ), content.size() - 1 );
+
+        for( size_t offset = std::max<size_t>( next, match.from - match.from % HEX_ROW ); offset <= last; offset += HEX_ROW ) {
+            while( lastByte( matches[first] ) < offset ) { ++first; }
+
+            this->row( content, offset, matches, first, prefix );
+            next = offset + HEX_ROW;
+        }
+    }
+
+    if( !opts.piped ) { prints.emplace_back( utils::printFunc( Color::Neutral, "\n\n" ) ); }
+}
+
+void HexPrinter::row( const std::string_view& content, const size_t offset, const search::Matches& matches, const size_t first, const std::string& prefix ) {
+    static const char* digits = "0123456789abcdef";
+    const size_t end = std::min( offset + HEX_ROW, content.size() );
+
+    prints.emplace_back( utils::printFunc( Color::Neutral, prefix ) );
+    prints.emplace_back( utils::printFunc( cblue, utils::format( opts.piped ? "0x%08zx:" : "0x%08zx : ", offset ) ) );
+
+    // hex, then ASCII dump, bytes of matches in red
+    for( const bool ascii : { false, true } ) {
+        std::string text;
+        bool red = false;
+        size_t current = first;
+
+        for( size_t pos = offset; pos < offset + HEX_ROW; ++pos ) {
+            while( current < matches.size() && lastByte( matches[current] ) < pos ) { ++current; }
+
+            const bool inMatch = pos < end && current < matches.size() && matches[current].from <= pos;
+
+            if( inMatch != red ) {
+                prints.emplace_back( utils::printFunc( red ? cred : Color::Neutral, text ) );
+                text.clear();
+                red = inMatch;
+            }
+
+            if( pos >= end ) {
+                if( !ascii ) { text += "   "; }
+            } else if( ascii ) {
+                const unsigned char c = static_cast<unsigned char>( content[pos] );
+                text += c >= 0x20 && c < 0x7f ? static_cast<char>( c ) : '.';
+            } else {
+                const unsigned char c = static_cast<unsigned char>( content[pos] );
+                text += digits[c >> 4];
+                text += digits[c & 0xf];
+                text += ' ';
+            }
+        }
+
+        if( !ascii ) { text += ' '; }
+
+        prints.emplace_back( utils::printFunc( red ? cred : Color::Neutral, text ) );
+    }
+
+    if( opts.piped ) { prints.emplace_back( utils::printFunc( Color::Neutral, "\n" ) ); }
+}
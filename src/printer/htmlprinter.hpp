@@ -69,7 +69,9 @@ struct HtmlPrinter : public Printer {
     static fs::path html;
 
     std::stringstream result;
-    virtual void collectPrints( const sys_string& path, const std::vector<search::Match>& matches, const std::string_view& content ) override;
+    virtual void collectPrints( const sys_string& path, const search::Matches& matches, const search::Lines& lines, const std::string_view& content ) override;
+    virtual void collectCount( const sys_string& path, const size_t count ) override;
+    virtual void collectFile( const sys_string& path ) override;
     virtual void printPrints() override;
     HtmlPrinter( const SearchOptions& opts ) : Printer( opts ) {
         std::call_once( oneHeader, [this] {
@@ -113,12 +115,23 @@ struct HtmlPrinter : public Printer {
     inline void ellipsis() {
         result << "<span class=\"gray\">...</span>";
     }
+    //! writes text in spans of css class cls, each line of a match across lines gets its line number
+    inline void code( const char* cls, const std::string& text, search::Offset& number ) {
+        size_t from = 0;
+
+        for( size_t newline; ( newline = text.find( '\n', from ) ) != std::string::npos; from = newline + 1 ) {
+            result << "<span class=\"" << cls << "\">" << HTML::encode( text.substr( from, newline - from ) ) << "</span>\n";
+            result << "<span class=\"line\">" << HTML::encode( utils::format( "L%4i : ", ++number ) ) << "</span>";
+        }
+
+        result << "<span class=\"" << cls << "\">" << HTML::encode( from ? text.substr( from ) : text ) << "</span>";
+    }
 };
 
 std::once_flag HtmlPrinter::oneHeader;
 fs::path HtmlPrinter::html;
 
-void HtmlPrinter::collectPrints( const sys_string& path, const std::vector<search::Match>& matches, const std::string_view& content ) {
+void HtmlPrinter::collectPrints( const sys_string& path, const search::Matches& matches, const search::Lines& lines, const std::string_view& content ) {
     result.str( std::string() );
     std::string uri = HTML::encode( "file://" + fromSysString( opts.pathPrefix + path ) );
 
@@ -132,53 +145,52 @@ void HtmlPrinter::collectPrints( const sys_string& path, const std::vector<searc
            << uri <<
            "</a>\n";
 
-    // parse file for newlines until last match
-    long long stop = matches.back().second - content.cbegin();
-    const utils::Lines lines = utils::parseContent( content.data(), content.size(), stop );
-
+    // lines of matches, found by the searcher
     size_t lineNo = 0;
     size_t size = lines.size();
     size_t printed = size + 1; // init with unreachable line number
+    search::Offset current = 0; // of the printed line within lines of matches across lines
 
-    std::vector<search::Match>::const_iterator match = matches.cbegin();
-    std::vector<search::Match>::const_iterator end = matches.cend();
+    search::Matches::const_iterator match = matches.cbegin();
+    search::Matches::const_iterator end = matches.cend();
 
     for( ; match != end; ) {
 
         // find line for match
-        while( !( match->first < lines[lineNo].cend() ) ) {
+        while( !( match->from < lines[lineNo].end ) ) {
             ++lineNo;
         }
 
         assert( lineNo < size );
 
-        const std::string_view& line = lines[lineNo];
+        const std::string_view line = lines[lineNo].view( content );
 
         // print lineNo and code until match start
         if( printed != lineNo ) {
             printed = lineNo;
+            current = lines[lineNo].number;
 
             // line in blue
-            std::string number = utils::format( "L%4i : ", lineNo + 1 );
+            std::string number = utils::format( "L%4i : ", lines[lineNo].number );
             result << "<span class=\"line\">" << HTML::encode( number ) << "</span>";
 
             // code in neutral
-            if( line.cbegin() < match->first ) {
+            if( line.cbegin() < match->begin( content ) ) {
                 // elide left if line is too long
-                if( match->first - line.cbegin() > CUT_OFF ) {
+                if( match->begin( content ) - line.cbegin() > CUT_OFF ) {
                     this->ellipsis();
-                    result << "<span class=\"code\">" << HTML::encode( std::string( match->first - CUT_OFF, match->first ) ) << "</span>";
+                    this->code( "code", std::string( match->begin( content ) - CUT_OFF, match->begin( content ) ), current );
                 } else {
-                    result << "<span class=\"code\">" << HTML::encode( std::string( line.cbegin(), match->first ) ) << "</span>";
+                    this->code( "code", std::string( line.cbegin(), match->begin( content ) ), current );
                 }
             }
         }
 
         // print match in red
-        result << "<span class=\"match\">" << HTML::encode( std::string( match->first, match->second ) ) << "</span>";
+        this->code( "match", std::string( match->begin( content ), match->end( content ) ), current );
 
         // set from to end of match
-        search::Iter from = match->second;
+        search::Iter from = match->end( content );
 
         // if there are no more matches in this file, print rest of line in neutral
         // and exit search for this file
@@ -186,10 +198,11 @@ void HtmlPrinter::collectPrints( const sys_string& path, const std::vector<searc
             if( from < line.cend() ) {
                 // elide right if line is too long
                 if( line.cend() - from > CUT_OFF ) {
-                    result << "<span class=\"code\">" << HTML::encode( std::string( from, from + CUT_OFF ) ) << "</span>";
+                    this->code( "code", std::string( from, from + CUT_OFF ), current );
                     this->ellipsis();
                 } else {
-                    result << "<span class=\"code\">" << HTML::encode( std::string( from, line.cend() ) ) << "</span>\n";
+                    this->code( "code", std::string( from, line.cend() ), current );
+                    result << "\n";
                 }
 
             }
@@ -200,14 +213,14 @@ void HtmlPrinter::collectPrints( const sys_string& path, const std::vector<searc
         ++match;
 
         // if next match is within this line, print code in neutral until next match
-        if( match->first < line.cend() ) {
-            if( match->first - from > CUT_OFF ) {
+        if( match->begin( content ) < line.cend() ) {
+            if( match->begin( content ) - from > CUT_OFF ) {
                 // elide middle if line is too long
-                result << "<span class=\"code\">" << HTML::encode( std::string( from, from + CUT_OFF / 2 ) ) << "</span>";
+                this->code( "code", std::string( from, from + CUT_OFF / 2 ), current );
                 this->ellipsis();
-                result << "<span class=\"code\">" << HTML::encode( std::string( match->first - CUT_OFF / 2, match->first ) ) << "</span>";
+                this->code( "code", std::string( match->begin( content ) - CUT_OFF / 2, match->begin( content ) ), current );
             } else {
-                result << "<span class=\"code\">" << HTML::encode( std::string( from, match->first ) ) << "</span>";
+                this->code( "code", std::string( from, match->begin( content ) ), current );
             }
 
         }
@@ -215,10 +228,11 @@ void HtmlPrinter::collectPrints( const sys_string& path, const std::vector<searc
         else {
             // elide right if line is too long
             if( line.cend() - from > CUT_OFF ) {
-                result << "<span class=\"code\">" << HTML::encode( std::string( from, from + CUT_OFF ) ) << "</span>";
+                this->code( "code", std::string( from, from + CUT_OFF ), current );
                 this->ellipsis();
             } else {
-                result << "<span class=\"code\">" << HTML::encode( std::string( from, line.cend() ) ) << "</span>\n";
+                this->code( "code", std::string( from, line.cend() ), current );
+                result << "\n";
             }
         }
     }
@@ -228,6 +242,33 @@ end:
     result << "</div>\n\n";
 }
 
+void HtmlPrinter::collectCount( const sys_string& path, const size_t count ) {
+    result.str( std::string() );
+    std::string uri = HTML::encode( "file://" + fromSysString( opts.pathPrefix + path ) );
+
+    result << "<div class=\"result\">\n"
+           << "<a class=\"file\" href=\""
+           << uri
+           << "\" download>"
+           << uri
+           << "</a>"
+           << "<span class=\"line\"> : " << count << "</span>\n"
+           << "</div>\n\n";
+}
+
+void HtmlPrinter::collectFile( const sys_string& path ) {
+    result.str( std::string() );
+    std::string uri = HTML::encode( "file://" + fromSysString( opts.pathPrefix + path ) );
+
+    result << "<div class=\"result\">\n"
+           << "<a class=\"file\" href=\""
+           << uri
+           << "\" download>"
+           << uri
+           << "</a>\n"
+           << "</div>\n\n";
+}
+
 void HtmlPrinter::printPrints() {
     fs::ofstream of( html, std::ios::out | std::ios::binary | std::ios::app );
 
@@ -1,46 +1,46 @@
 #pragma once
 
 #include "printer.hpp"
+#include "boost/algorithm/string/replace.hpp"
 
 struct PipedPrinter : public Printer {
     using Print = std::function<void()>;
     std::vector<Print> prints;
-    virtual void collectPrints( const sys_string& path, const std::vector<search::Match>& matches, const std::string_view& content ) override;
+    virtual void collectPrints( const sys_string& path, const search::Matches& matches, const search::Lines& lines, const std::string_view& content ) override;
+    virtual void collectCount( const sys_string& path, const size_t count ) override;
+    virtual void collectFile( const sys_string& path ) override;
     virtual void printPrints() override;
     PipedPrinter( const SearchOptions& opts ) : Printer( opts ) {}
     virtual ~PipedPrinter() override {}
 };
 
-void PipedPrinter::collectPrints( const sys_string& path, const std::vector<search::Match>& matches, const std::string_view& content ) {
+void PipedPrinter::collectPrints( const sys_string& path, const search::Matches& matches, const search::Lines& lines, const std::string_view& content ) {
     prints.clear();
     prints.reserve( 3 * matches.size() );
 
     // don't pipe colors
     Color neutral = Color::Neutral;
 
-    // parse file for newlines until last match
-    long long stop = matches.back().second - content.cbegin();
-    const utils::Lines lines = utils::parseContent( content.data(), content.size(), stop );
-
+    // lines of matches, found by the searcher
     size_t lineNo = 0;
     size_t size = lines.size();
     size_t printed = size + 1; // init with unreachable line number
 
-    std::vector<search::Match>::const_iterator match = matches.cbegin();
-    std::vector<search::Match>::const_iterator end = matches.cend();
+    search::Matches::const_iterator match = matches.cbegin();
+    search::Matches::const_iterator end = matches.cend();
 
     std::string filename( path.cbegin(), path.cend() );
 
     for( ; match != end; ) {
 
         // find line for match
-        while( !( match->first < lines[lineNo].cend() ) ) {
+        while( !( match->from < lines[lineNo].end ) ) {
             ++lineNo;
         }
 
         assert( lineNo < size );
 
-        const std::string_view& line = lines[lineNo];
+        const std::string_view line = lines[lineNo].view( content );
 
         // print lineNo and code until match start
         if( printed != lineNo ) {
@@ -51,12 +51,19 @@ void PipedPrinter::collectPrints( const sys_string& path, const std::vector<sear
 
             // code in neutral
             prints.emplace_back( utils::printFunc( neutral, ":" ) );
-            prints.emplace_back( utils::printFunc( neutral, std::string( line ) ) );
+            std::string code( line );
+
+            // each line of a match across lines gets the file path
+            if( code.find( '\n' ) != std::string::npos ) [[unlikely]] {
+                boost::algorithm::replace_all( code, "\n", "\n" + filename + ":" );
+            }
+
+            prints.emplace_back( utils::printFunc( neutral, code ) );
             prints.emplace_back( utils::printFunc( neutral, "\n" ) );
         }
 
         // search first match not in this line anymore
-        while( match->first < line.cend() ) {
+        while( match->begin( content ) < line.cend() ) {
             match++;
 
             // if there are no more matches in this file, exit search for this file
@@ -70,6 +77,22 @@ end:
     void();
 }
 
+// like grep -c
+void PipedPrinter::collectCount( const sys_string& path, const size_t count ) {
+    prints.clear();
+
+    std::string filename( path.cbegin(), path.cend() );
+    prints.emplace_back( utils::printFunc( Color::Neutral, utils::format( "%s:%lu\n", filename.c_str(), count ) ) );
+}
+
+// like grep -l
+void PipedPrinter::collectFile( const sys_string& path ) {
+    prints.clear();
+
+    std::string filename( path.cbegin(), path.cend() );
+    prints.emplace_back( utils::printFunc( Color::Neutral, filename + "\n" ) );
+}
+
 void PipedPrinter::printPrints() {
     for( const std::function<void()>& func : prints ) { func(); }
 }
@@ -6,7 +6,9 @@
 struct PrettyPrinter : public Printer {
     using Print = std::function<void()>;
     std::vector<Print> prints;
-    virtual void collectPrints( const sys_string& path, const std::vector<search::Match>& matches, const std::string_view& content ) override;
+    virtual void collectPrints( const sys_string& path, const search::Matches& matches, const search::Lines& lines, const std::string_view& content ) override;
+    virtual void collectCount( const sys_string& path, const size_t count ) override;
+    virtual void collectFile( const sys_string& path ) override;
     virtual void printPrints() override;
     PrettyPrinter( const SearchOptions& opts ) : Printer( opts ) {
         // don't pipe colors
@@ -21,6 +23,26 @@ struct PrettyPrinter : public Printer {
     inline void ellipsis() {
         prints.emplace_back( utils::printFunc( cgray, "..." ) );
     }
+    //! prints code, each line of a match across lines gets its line number
+    inline void code( const Color color, const std::string& text, search::Offset& number ) {
+        size_t from = 0;
+
+        for( size_t newline; ( newline = text.find( '\n', from ) ) != std::string::npos; from = newline + 1 ) {
+            prints.emplace_back( utils::printFunc( color, text.substr( from, newline - from ) ) );
+            prints.emplace_back( utils::printFunc( cblue, utils::format( "\nL%4i : ", ++number ) ) );
+        }
+
+        prints.emplace_back( utils::printFunc( color, from ? text.substr( from ) : text ) );
+    }
+    inline void filePath( const sys_string& path ) {
+#ifdef _WIN32
+        sys_string complete = opts.pathPrefix + path;
+        boost::algorithm::replace_all( complete, L"\\", L"/" );
+        prints.emplace_back( utils::printFunc( cgreen, uriPrefix + std::string( complete.cbegin(), complete.cend() ) ) );
+#else
+        prints.emplace_back( utils::printFunc( cgreen, uriPrefix + opts.pathPrefix + path ) );
+#endif
+    }
 
     Color cred;
     Color cblue;
@@ -33,73 +55,60 @@ struct PrettyPrinter : public Printer {
 #endif
 };
 
-void PrettyPrinter::collectPrints( const sys_string& path, const std::vector<search::Match>& matches, const std::string_view& content ) {
+void PrettyPrinter::collectPrints( const sys_string& path, const search::Matches& matches, const search::Lines& lines, const std::string_view& content ) {
     prints.clear();
     prints.reserve( 3 * matches.size() );
 
     // print file path
-#ifdef _WIN32
-    sys_string complete = opts.pathPrefix + path;
-    boost::algorithm::replace_all( complete, L"\\", L"/" );
-    prints.emplace_back( utils::printFunc( cgreen, uriPrefix + std::string( complete.cbegin(), complete.cend() ) ) );
-#else
-    prints.emplace_back( utils::printFunc( cgreen, uriPrefix + opts.pathPrefix + path ) );
-#endif
-
-
-    if( opts.onlyFiles ) [[unlikely]] {
-        prints.emplace_back( utils::printFunc( Color::Neutral, "\n\n" ) );
-        return;
-    }
-
-    // parse file for newlines until last match
-    long long stop = matches.back().second - content.cbegin();
-    const utils::Lines lines = utils::parseContent( content.data(), content.size(), stop );
+    this->filePath( path );
 
+    // lines of matches, found by the searcher
     size_t lineNo = 0;
     size_t size = lines.size();
     size_t printed = size + 1; // init with unreachable line number
+    search::Offset current = 0; // of the printed line within lines of matches across lines
 
-    std::vector<search::Match>::const_iterator match = matches.cbegin();
-    std::vector<search::Match>::const_iterator end = matches.cend();
+    search::Matches::const_iterator match = matches.cbegin();
+    search::Matches::const_iterator end = matches.cend();
 
     for( ; match != end; ) {
 
         // find line for match
-        while( !( match->first < lines[lineNo].cend() ) ) {
+        while( !( match->from < lines[lineNo].end ) ) {
             ++lineNo;
         }
 
         assert( lineNo < size );
 
-        const std::string_view& line = lines[lineNo];
+        const std::string_view line = lines[lineNo].view( content );
 
         // print lineNo and code until match start
         if( printed != lineNo ) {
             printed = lineNo;
+            current = lines[lineNo].number;
 
             // line in blue
-            std::string number = utils::format( "\nL%4i : ", lineNo + 1 );
+            std::string number = utils::format( "\nL%4i : ", lines[lineNo].number );
             prints.emplace_back( utils::printFunc( cblue, number ) );
 
             // code in neutral
-            if( line.cbegin() < match->first ) {
+            if( line.cbegin() < match->begin( content ) ) {
                 // elide left if line is too long
-                if( match->first - line.cbegin() > CUT_OFF ) {
+                if( match->begin( content ) - line.cbegin() > CUT_OFF ) {
                     this->ellipsis();
-                    prints.emplace_back( utils::printFunc( Color::Neutral, std::string( match->first - CUT_OFF, match->first ) ) );
+                    this->code( Color::Neutral, std::string( match->begin( content ) - CUT_OFF, match->begin( content ) ), current );
                 } else {
-                    prints.emplace_back( utils::printFunc( Color::Neutral, std::string( line.cbegin(), match->first ) ) );
+                    this->code( Color::Neutral, std::string( line.cbegin(), match->begin( content ) ), current );
                 }
             }
         }
 
 
         // print match in red
-        prints.emplace_back( utils::printFunc( cred, std::string( match->first, match->second ) ) );
+        this->code( cred, std::string( match->begin( content ), match->end( content ) ), current );
 
         // set from to end of match
-        search::Iter from = match->second;
+        search::Iter from = match->end( content );
 
         // if there are no more matches in this file, print rest of line in neutral
         // and exit search for this file
@@ -107,10 +116,10 @@ void PrettyPrinter::collectPrints( const sys_string& path, const std::vector<sea
             if( from < line.cend() ) {
                 // elide right if line is too long
                 if( line.cend() - from > CUT_OFF ) {
-                    prints.emplace_back( utils::printFunc( Color::Neutral, std::string( from, from + CUT_OFF ) ) );
+                    this->code( Color::Neutral, std::string( from, from + CUT_OFF ), current );
                     this->ellipsis();
                 } else {
-                    prints.emplace_back( utils::printFunc( Color::Neutral, std::string( from, line.cend() ) ) );
+                    this->code( Color::Neutral, std::string( from, line.cend() ), current );
                 }
             }
 
@@ -120,24 +129,24 @@ void PrettyPrinter::collectPrints( const sys_string& path, const std::vector<sea
         ++match;
 
         // if next match is within this line, print code in neutral until next match
-        if( match->first < line.cend() ) {
-            if( match->first - from > CUT_OFF ) {
+        if( match->begin( content ) < line.cend() ) {
+            if( match->begin( content ) - from > CUT_OFF ) {
                 // elide middle if line is too long
-                prints.emplace_back( utils::printFunc( Color::Neutral, std::string( from, from + CUT_OFF / 2 ) ) );
+                this->code( Color::Neutral, std::string( from, from + CUT_OFF / 2 ), current );
                 this->ellipsis();
-                prints.emplace_back( utils::printFunc( Color::Neutral, std::string( match->first - CUT_OFF / 2, match->first ) ) );
+                this->code( Color::Neutral, std::string( match->begin( content ) - CUT_OFF / 2, match->begin( content ) ), current );
             } else {
-                prints.emplace_back( utils::printFunc( Color::Neutral, std::string( from, match->first ) ) );
+                this->code( Color::Neutral, std::string( from, match->begin( content ) ), current );
             }
         }
         // else print code in neutral until end
         else {
             // elide right if line is too long
             if( line.cend() - from > CUT_OFF ) {
-                prints.emplace_back( utils::printFunc( Color::Neutral, std::string( from, from + CUT_OFF ) ) );
+                this->code( Color::Neutral, std::string( from, from + CUT_OFF ), current );
                 this->ellipsis();
             } else {
-                prints.emplace_back( utils::printFunc( Color::Neutral, std::string( from, line.cend() ) ) );
+                this->code( Color::Neutral, std::string( from, line.cend() ), current );
             }
         }
     }
@@ -147,6 +156,25 @@ end:
     prints.emplace_back( utils::printFunc( Color::Neutral, "\n\n" ) );
 }
 
+void PrettyPrinter::collectCount( const sys_string& path, const size_t count ) {
+    prints.clear();
+
+    // print file path
+    this->filePath( path );
+
+    // count in blue
+    prints.emplace_back( utils::printFunc( cblue, utils::format( " : %lu\n", count ) ) );
+}
+
+void PrettyPrinter::collectFile( const sys_string& path ) {
+    prints.clear();
+
+    // print file path
+    this->filePath( path );
+
+    prints.emplace_back( utils::printFunc( Color::Neutral, "\n\n" ) );
+}
+
 void PrettyPrinter::printPrints() {
     for( const std::function<void()>& func : prints ) { func(); }
 }
@@ -13,7 +13,11 @@ struct Printer {
     const SearchOptions& opts;
     Printer( const SearchOptions& opts ) : opts( opts ) {}
     //! collect what is printed
-    virtual void collectPrints( const sys_string& path, const std::vector<search::Match>& matches, const std::string_view& content ) = 0;
+    virtual void collectPrints( const sys_string& path, const search::Matches& matches, const search::Lines& lines, const std::string_view& content ) = 0;
+    //! collect number of matches for --count
+    virtual void collectCount( const sys_string& path, const size_t count ) = 0;
+    //! collect filename for --files
+    virtual void collectFile( const sys_string& path ) = 0;
     //! call print functions locked
     virtual void printPrints() = 0;
     virtual ~Printer() {}
@@ -3,6 +3,7 @@
 #include "prettyprinter.hpp"
 #include "pipedprinter.hpp"
 #include "htmlprinter.hpp"
+#include "hexprinter.hpp"
 #include "searchoptions.hpp"
 
 namespace printerfactory {
@@ -15,6 +16,14 @@ std::function<Printer*()> printerFunc( const SearchOptions& opts ) {
         };
     }
 
+    // --count and --files print like text searches
+    if( opts.binary && !opts.count && !opts.onlyFiles ) {
+        return [&opts] {
+            HexPrinter* printer = new HexPrinter( opts );
+            return printer;
+        };
+    }
+
     if( opts.piped ) {
         return [&opts] {
             PipedPrinter* printer = new PipedPrinter( opts );
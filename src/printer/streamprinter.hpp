@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+
+#include "printer.hpp"
+
+//! hands the matches of each file to a callback instead of printing them, for session::Session
+struct StreamPrinter : public Printer {
+    using OnResult = std::function<void( const search::Result& result )>;
+    const OnResult& onResult;
+    const std::atomic_bool& superseded; // drops the results of a query, which a newer one cancelled
+    search::Result result;
+    void reset( const sys_string& path, const size_t count );
+    virtual void collectPrints( const sys_string& path, const search::Matches& matches, const search::Lines& lines, const std::string_view& content ) override;
+    virtual void collectCount( const sys_string& path, const size_t count ) override;
+    virtual void collectFile( const sys_string& path ) override;
+    virtual void printPrints() override;
+    StreamPrinter( const SearchOptions& opts, const OnResult& onResult, const std::atomic_bool& superseded ) :
+        Printer( opts ), onResult( onResult ), superseded( superseded ) {}
+    virtual ~StreamPrinter() override {}
+};
+
+void StreamPrinter::reset( const sys_string& path, const size_t count ) {
+    result.path = fromSysString( opts.pathPrefix + path );
+    result.count = count;
+    result.text.clear();
+    result.lines.clear();
+    result.matches.clear();
+}
+
+void StreamPrinter::collectPrints( const sys_string& path, const search::Matches& matches, const search::Lines& lines, const std::string_view& content ) {
+    reset( path, matches.size() );
+
+    if( lines.empty() ) { return; }
+
+    // lines of matches, found by the searcher
+    size_t lineNo = 0;
+    size_t taken = lines.size(); // init with unreachable line number
+    size_t offset = 0;           // of the taken line in text
+
+    for( const search::Match& match : matches ) {
+
+        // find line for match
+        while( !( match.from < lines[lineNo].end ) && lineNo + 1 < lines.size() ) {
+            ++lineNo;
+        }
+
+        const search::Line& line = lines[lineNo];
+
+        if( taken != lineNo ) {
+            taken = lineNo;
+            offset = result.text.size();
+            result.text.append( line.view( content ) );
+            result.text += '\n';
+
+            search::Line copy;
+            copy.number = line.number;
+            copy.begin = static_cast<search::Offset>( offset );
+            copy.end = static_cast<search::Offset>( offset + line.end - line.begin );
+            result.lines.push_back( copy );
+        }
+
+        // rebase match into text
+        result.matches.emplace_back( offset + match.from - line.begin, offset + std::min( match.to, line.end ) - line.begin );
+    }
+}
+
+void StreamPrinter::collectCount( const sys_string& path, const size_t count ) {
+    reset( path, count );
+}
+
+void StreamPrinter::collectFile( const sys_string& path ) {
+    reset( path, 1 );
+}
+
+void StreamPrinter::printPrints() {
+    if( !superseded ) { onResult( result ); }
+}
@@ -0,0 +1,186 @@
+#include "query.hpp"
+
+#include <cstring>
+#include <cctype>
+
+namespace query {
+
+namespace {
+
+struct Parser {
+    const std::string& text;
+    size_t pos = 0;
+    size_t leaves = 0;
+    std::string error;
+
+    Parser( const std::string& text ) : text( text ) {}
+
+    inline void skipSpaces() {
+        while( pos < text.size() && isspace( static_cast<unsigned char>( text[pos] ) ) ) { ++pos; }
+    }
+
+    inline bool next( const char c ) {
+        skipSpaces();
+
+        if( pos < text.size() && text[pos] == c ) {
+            ++pos;
+            return true;
+        }
+
+        return false;
+    }
+
+    //! reads "quoted" or /delimited/ text, backslash escapes the delimiter
+    inline bool delimited( const char delimiter, std::string& out ) {
+        for( ++pos; pos < text.size(); ++pos ) {
+            if( text[pos] == delimiter ) {
+                ++pos;
+                return true;
+            }
+
+            if( text[pos] == '\\' && pos + 1 < text.size() && text[pos + 1] == delimiter ) { ++pos; }
+            // keep other escapes for regexes
+            else if( text[pos] == '\\' && delimiter == '"' && pos + 1 < text.size() && text[pos + 1] == '\\' ) { ++pos; }
+
+            out += text[pos];
+        }
+
+        error = std::string( "missing closing " ) + delimiter;
+        return false;
+    }
+
+    inline bool leaf( Node& node ) {
+        skipSpaces();
+        node.type = Node::Type::Leaf;
+        node.leaf = leaves++;
+
+        if( pos < text.size() && text[pos] == '"' ) { return delimited( '"', node.term ) && !empty( node ); }
+
+        if( pos < text.size() && text[pos] == '/' ) {
+            node.isRegex = true;
+            return delimited( '/', node.term ) && !empty( node );
+        }
+
+        while( pos < text.size() && !isspace( static_cast<unsigned char>( text[pos] ) ) && !strchr( "&|!()\"~", text[pos] ) ) {
+            node.term += text[pos++];
+        }
+
+        return !empty( node );
+    }
+
+    inline bool empty( const Node& node ) {
+        if( !node.term.empty() ) { return false; }
+
+        error = "empty term at " + std::to_string( pos );
+        return true;
+    }
+
+    inline bool unary( Node& node ) {
+        if( next( '!' ) ) {
+            node.type = Node::Type::Not;
+            node.children.emplace_back();
+            return unary( node.children.back() );
+        }
+
+        if( next( '(' ) ) {
+            if( !expression( node ) ) { return false; }
+
+            if( next( ')' ) ) { return true; }
+
+            error = "missing ) at " + std::to_string( pos );
+            return false;
+        }
+
+        return leaf( node );
+    }
+
+    //! parses 'a ~n b' of two leaves
+    inline bool proximity( Node& node ) {
+        Node first;
+
+        if( !unary( first ) ) { return false; }
+
+        if( !next( '~' ) ) {
+            node = std::move( first );
+            return true;
+        }
+
+        const size_t digits = pos;
+
+        while( pos < text.size() && isdigit( static_cast<unsigned char>( text[pos] ) ) ) { ++pos; }
+
+        if( pos == digits || pos - digits > 9 ) {
+            error = "invalid number of lines after ~ at " + std::to_string( digits );
+            return false;
+        }
+
+        node.type = Node::Type::Near;
+        node.distance = std::stoul( text.substr( digits, pos - digits ) );
+        node.children.emplace_back( std::move( first ) );
+        node.children.emplace_back();
+
+        if( !unary( node.children.back() ) ) { return false; }
+
+        if( node.children.front().type != Node::Type::Leaf || node.children.back().type != Node::Type::Leaf ) {
+            error = "~ needs a term on both sides at " + std::to_string( pos );
+            return false;
+        }
+
+        return true;
+    }
+
+    //! parses a list of sub nodes separated by op
+    template<typename Sub>
+    inline bool list( Node& node, const char op, const Node::Type type, Sub sub ) {
+        Node first;
+
+        if( !sub( first ) ) { return false; }
+
+        if( !next( op ) ) {
+            node = std::move( first );
+            return true;
+        }
+
+        node.type = type;
+        node.children.emplace_back( std::move( first ) );
+
+        do {
+            node.children.emplace_back();
+
+            if( !sub( node.children.back() ) ) { return false; }
+        } while( next( op ) );
+
+        return true;
+    }
+
+    inline bool conjunction( Node& node ) {
+        return list( node, '&', Node::Type::And, [this]( Node & sub ) { return proximity( sub ); } );
+    }
+
+    inline bool expression( Node& node ) {
+        return list( node, '|', Node::Type::Or, [this]( Node & sub ) { return conjunction( sub ); } );
+    }
+};
+
+}
+
+bool parse( const std::string& text, Node& root, std::string& error ) {
+    Parser parser( text );
+    root = Node();
+
+    if( parser.expression( root ) ) {
+        parser.skipSpaces();
+
+        if( parser.pos == text.size() ) {
+            order( root );
+            return true;
+        }
+
+        parser.error = "unexpected '" + std::string( 1, text[parser.pos] ) + "' at " + std::to_string( parser.pos );
+    }
+
+    error = parser.error;
+    return false;
+}
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+//! boolean file queries like 'open & (read | write) & !close'
+//! leaves are literals, "quoted literals" or /regexes/, ~ binds stronger than &, & stronger than |
+//! 'lock ~5 return' matches lock and return within 5 lines of each other
+namespace query {
+
+struct Node {
+    enum class Type { Leaf, And, Or, Not, Near };
+
+    Type type = Type::Leaf;
+    std::string term;            // for leaves
+    bool isRegex = false;        // for /leaves/
+    size_t leaf = 0;             // index of leaf in query
+    size_t distance = 0;         // max lines between the two leaves of Near
+    std::vector<Node> children;  // for And, Or and Not
+
+    //! rough cost of evaluating this node on a file, regexes are slower than literals
+    inline size_t cost() const {
+        if( type == Type::Leaf ) { return isRegex ? 4 : 1; }
+
+        size_t sum = 0;
+
+        for( const Node& child : children ) { sum += child.cost(); }
+
+        return sum;
+    }
+};
+
+//! evaluates cheap children first, and in ANDs long literals, as they are rare and fail early
+inline void order( Node& node ) {
+    for( Node& child : node.children ) { order( child ); }
+
+    const bool isAnd = node.type == Node::Type::And;
+
+    std::stable_sort( node.children.begin(), node.children.end(), [isAnd]( const Node & a, const Node & b ) {
+        if( a.cost() != b.cost() ) { return a.cost() < b.cost(); }
+
+        return isAnd && a.type == Node::Type::Leaf && b.type == Node::Type::Leaf && a.term.size() > b.term.size();
+    } );
+}
+
+//! \returns true, if node matches a file, which contains none of the leaves, e.g. '!a'
+inline bool matchesEmpty( const Node& node ) {
+    switch( node.type ) {
+        case Node::Type::Leaf:
+        case Node::Type::Near: return false;
+
+        case Node::Type::Not: return !matchesEmpty( node.children.front() );
+
+        case Node::Type::And: return std::all_of( node.children.cbegin(), node.children.cend(), matchesEmpty );
+
+        case Node::Type::Or: return std::any_of( node.children.cbegin(), node.children.cend(), matchesEmpty );
+    }
+
+    return false;
+}
+
+//! calls onLeaf for all leaves
+template<typename OnLeaf>
+inline void leaves( const Node& node, OnLeaf onLeaf ) {
+    if( node.type == Node::Type::Leaf ) {
+        onLeaf( node );
+        return;
+    }
+
+    for( const Node& child : node.children ) { leaves( child, onLeaf ); }
+}
+
+//! parses and orders text into root
+//! \returns false and sets error on syntax errors
+bool parse( const std::string& text, Node& root, std::string& error );
+
+}
@@ -3,15 +3,17 @@
 #include "searchcontroller.hpp"
 #include "printer/printer.hpp"
 #include "searcher/searcher.hpp"
+#include "server.hpp"
 
-void SearchController::onAllFiles() {
-    this->printHeader();
+std::atomic_size_t SearchController::controllers = {0};
 
-    POOL;
+template<class Pool>
+void SearchController::walk( Pool& pool, const Walker& walker ) {
+    pool.cancelOn( cancelled );
     STOPWATCH
     START
 
-    utils::recurseDir( opts.path.native(), [&pool, this]( const sys_string & filename ) {
+    walker( [&pool, this]( const sys_string & filename ) {
         if( glob && !glob.matches( filename ) ) { return; }
 
         pool.add( [filename, this] {
@@ -25,25 +27,77 @@ void SearchController::onAllFiles() {
     STOP( stats.t_recurse )
 }
 
+void SearchController::start( const Walker& walker ) {
+#if THREADPOOL == OWN_THREADPOOL
+
+    if( warmPool ) {
+        walk( *warmPool, walker );
+        warmPool->wait();
+        return;
+    }
+
+#endif
+
+    POOL;
+    walk( pool, walker );
+}
+
+void SearchController::onAllFiles() {
+    this->printHeader();
+
+    start( [this]( const std::function<void( const sys_string& filename )>& onFile ) {
+        utils::recurseDir( opts.path.native(), onFile, cancelled );
+    } );
+}
+
 void SearchController::onGitFiles() {
     this->printGitHeader();
 
-    POOL;
-    STOPWATCH
-    START
+    start( [this]( const std::function<void( const sys_string& filename )>& onFile ) {
+        if( !warmFiles ) {
+            utils::gitLsFiles( opts.path, onFile, cancelled );
+            return;
+        }
 
-    utils::gitLsFiles( opts.path, [&pool, this]( const sys_string & filename ) {
-        if( glob && !glob.matches( filename ) ) { return; }
+        // relative paths like git ls-files
+        fs::current_path( opts.path );
 
-        pool.add( [filename, this] {
-#if DETAILED_STATS
-            stats.filesSearched++;
-#endif
-            search( filename );
-        } );
+        for( const sys_string& filename : *warmFiles ) {
+            if( cancelled ) { break; }
+
+            onFile( filename );
+        }
     } );
+}
+
+void SearchController::run( server::Warm* warm ) {
+#if THREADPOOL == OWN_THREADPOOL
+
+    if( warm ) { warmPool = warm->pool.get(); }
+
+#endif
+
+    if( inGit() ) {
+        // git ls-files only runs again, if files were added, removed or staged
+        if( warm ) {
+            server::FileList& list = warm->lists[opts.path];
+            fs::current_path( opts.path );
+
+            if( !list.valid() ) { list.refresh( opts.path ); }
 
-    STOP( stats.t_recurse );
+            warmFiles = &list.files;
+        }
+
+        onGitFiles();
+    } else {
+        onAllFiles();
+    }
+
+    // a search, which stopped early or filtered files, didn't see deleted files
+    const bool complete = !cancelled && opts.glob.empty();
+    fingerprints.save( complete );
+    // files, which the index skipped, have no stat to find their metadata
+    metadata.save( complete && !filtered );
 }
 
 void SearchController::printHeader() {
@@ -81,6 +135,12 @@ void SearchController::printFooter( const StopWatch::ns_type& ms ) {
                                stats.filesSearched.load(),
                                stats.bytesRead.load() / 1024,
                                ms ) );
+
+        if( stats.filesSkipped ) {
+            utils::printColor( gray, utils::format(
+                                   "Skipped %lu files, which exceeded the regex budget\n",
+                                   stats.filesSkipped.load() ) );
+        }
     }
 }
 #endif
@@ -90,11 +150,35 @@ void SearchController::search( const sys_string& path ) {
     STOPWATCH
     START
 
+    // skip files, which the trigram index or their fingerprints rule out
+    if( filter.active && !filter.mayMatch( path ) ) {
+        fingerprints.see( path );
+        filtered = true;
+        return;
+    }
+
+    // stat once for the caches
+    trigram::Stamp stamp;
+    uint64_t device = 0;
+    const bool stamped = ( fingerprints.enabled || metadata.enabled ) && trigram::stamp( path, stamp, &device );
+
+    // skip empty files, and binaries, which an earlier search opened
+    const metadata::Kind kind = stamped ? metadata.kind( device, stamp ) : metadata::Kind::Unknown;
+
+    if( stamped && ( !stamp.size || ( kind == metadata::Kind::Binary && !opts.binary ) ) ) {
+        fingerprints.see( path );
+        return;
+    }
+
+    const fingerprint::Cache::Check check = stamped ? fingerprints.check( path, stamp ) : fingerprint::Cache::Check::Search;
+
+    if( check == fingerprint::Cache::Check::Skip ) { return; }
+
     // read file
 #ifndef _WIN32
-    utils::FileView view = utils::fromFileP( path );
+    utils::FileView view = opts.binary ? utils::fromMmap( path ) : utils::fromFileP( path );
 #else
-    utils::FileView view = utils::fromWinAPI( path );
+    utils::FileView view = utils::fromWinAPI( path, opts.binary );
 #endif
 
 #if DETAILED_STATS
@@ -102,34 +186,126 @@ void SearchController::search( const sys_string& path ) {
 #endif
     STOP( stats.t_read )
 
+    if( check == fingerprint::Cache::Check::Update ) { fingerprints.add( path, stamp, view ); }
+
+    if( stamped && kind == metadata::Kind::Unknown ) { metadata.add( device, stamp, view ); }
+
     if( !view.size ) { return; }
 
     // collect matches
     START
 
-    const std::string_view& content = view.content;
-    static thread_local std::unique_ptr<Searcher> searcher( makeSearcher() );
-    std::vector<search::Match> matches = searcher->search( content );
+    std::string_view content = view.content;
+
+    // search UTF-16 files in their UTF-8 lines, literals transcode only lines with the term
+    if( view.encoding != utils::Encoding::Utf8 ) {
+        static thread_local std::string transcoded;
+        const bool bigEndian = view.encoding == utils::Encoding::Utf16BE;
+
+        if( !utf16::toUtf8( content, bigEndian, bigEndian ? termBE : termLE, transcoded ) ) { return; }
+
+        // zero padding like utils::Buffer for the SSE kernels
+        const size_t size = transcoded.size();
+        transcoded.append( 16, '\0' );
+        content = std::string_view( transcoded.data(), size );
+    }
+
+    // threads of the daemon's pool outlive the controller
+    static thread_local size_t controller = 0;
+    static thread_local std::unique_ptr<Searcher> searcher;
+    static thread_local std::unique_ptr<Printer> printer;
+
+    if( controller != id ) {
+        controller = id;
+        searcher.reset( makeSearcher() );
+        printer.reset();
+    }
+
+    static thread_local search::Matches matches;
+    static thread_local search::Lines lines;
+    size_t found = 0;
+
+    // stop early with --max-count
+    searcher->cancelled = &cancelled;
+
+    if( opts.maxCount ) {
+        const size_t before = hits;
+
+        if( before >= opts.maxCount ) { return; }
+
+        searcher->limit = opts.maxCount - before;
+    }
+
+    // --files stops at the first match, --quiet and --count need no match positions
+    if( opts.onlyFiles ) {
+        found = searcher->any( content ) ? 1 : 0;
+    } else if( opts.quiet || opts.count ) {
+        found = searcher->count( content );
+    } else {
+        searcher->search( content, matches, lines );
+        found = matches.size();
+    }
 
     STOP( stats.t_search );
 
+    // report files, which exceeded the regex budget, w/out their partial matches
+    if( searcher->skipped ) [[unlikely]] {
+#if DETAILED_STATS
+        stats.filesSkipped++;
+#endif
+
+        if( !opts.quiet && !opts.piped ) {
+            std::unique_lock<std::mutex> lock( m );
+            utils::printColor( gray, "Skipped " + fromSysString( path ) + "\n\n" );
+        }
+
+        return;
+    }
+
+    // drop matches over --max-count, which other threads found in the meantime
+    if( found && opts.maxCount ) {
+        const size_t before = hits.fetch_add( found );
+
+        if( before >= opts.maxCount ) { return; }
+
+        if( before + found >= opts.maxCount ) {
+            found = opts.maxCount - before;
+            cancelled = true;
+
+            if( !matches.empty() ) {
+                matches.resize( found );
+
+                // drop lines w/out matches
+                while( lines.size() > 1 && matches.back().from < lines[lines.size() - 2].end ) { lines.pop_back(); }
+            }
+        }
+    }
+
     // handle matches
-    if( !matches.empty() ) {
+    if( found ) {
 #if DETAILED_STATS
         stats.filesMatched++;
-        stats.matches += matches.size();
+        stats.matches += found;
 #endif
 
+        if( opts.quiet ) { return; }
+
         START
-        static thread_local std::unique_ptr<Printer> printer( makePrinter() );
-        printer->collectPrints( path, matches, content );
-        STOP( stats.t_collect );
+        if( !printer ) { printer.reset( makePrinter() ); }
 
-        if( !opts.quiet ) {
-            START
-            std::unique_lock<std::mutex> lock( m );
-            printer->printPrints();
-            STOP( stats.t_print );
+        if( opts.onlyFiles ) {
+            printer->collectFile( path );
+        } else if( opts.count ) {
+            printer->collectCount( path, found );
+        } else {
+            printer->collectPrints( path, matches, lines, content );
         }
+
+        STOP( stats.t_collect );
+
+        START
+        std::unique_lock<std::mutex> lock( m );
+        printer->printPrints();
+        STOP( stats.t_print );
     }
 }
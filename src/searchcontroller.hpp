@@ -8,14 +8,24 @@
 #include "stopwatch.hpp"
 #include "searchoptions.hpp"
 #include "globmatcher.hpp"
+#include "utf16.hpp"
+#include "trigramindex.hpp"
+#include "fingerprints.hpp"
+#include "metadatacache.hpp"
 
 struct Printer;
 struct Searcher;
+class ThreadPool;
+
+namespace server {
+struct Warm;
+}
 
 struct Stats {
     std::atomic_size_t matches = {0};
     std::atomic_size_t filesSearched = {0};
     std::atomic_size_t filesMatched = {0};
+    std::atomic_size_t filesSkipped = {0}; // files, which exceeded the regex budget
     std::atomic_size_t bytesRead = {0};
 
     std::atomic_llong t_recurse = {0}; // time to recurse directory
@@ -28,26 +38,48 @@ struct Stats {
 struct SearchController {
     std::mutex m;
     std::string term;
+    std::string termLE; // UTF-16 encoded term for literal search in UTF-16 files
+    std::string termBE;
     SearchOptions opts;
     GlobMatcher glob;
     std::function<Searcher*()> makeSearcher;
     std::function<Printer*()> makePrinter;
+    trigram::Filter filter; // skips files w/out the term's trigrams
+    fingerprint::Cache fingerprints;
+    metadata::Cache metadata;
 #if DETAILED_STATS
     Stats stats;
 #endif
     Color gray = Color::Gray;
+    std::atomic_size_t hits = {0};         // matches in total for --max-count
+    std::atomic_bool cancelled = {false};  // stops walker, pool and searchers
+    std::atomic_bool filtered = {false};   // the trigram index skipped files w/out stat
+    const size_t id;                       // renews the searchers and printers of warm threads
+    ThreadPool* warmPool = nullptr;        // kept by the daemon
+    const std::vector<sys_string>* warmFiles = nullptr; // git ls-files of the daemon
 
     SearchController( const SearchOptions& opts, std::function<Searcher*()> searcher, std::function<Printer*()> printer ):
         opts( opts ),
         glob( opts.glob ),
         makeSearcher( searcher ),
-        makePrinter( printer ) {
+        makePrinter( printer ),
+        id( ++controllers ) {
 
         term = opts.term;
 
+        // other searches need the complete UTF-16 file as UTF-8
+        if( !opts.isRegex && !opts.isFuzzy && !opts.isQuery && !opts.multiline && !opts.ignoreCase ) {
+            termLE = utf16::fromUtf8( opts.term, false );
+            termBE = utf16::fromUtf8( opts.term, true );
+        }
+
         if( !opts.colorized ) {
             gray = Color::Neutral;
         }
+
+        filter.setup( opts );
+        fingerprints.setup( opts );
+        metadata.setup( opts );
     }
 
     ~SearchController() {}
@@ -55,10 +87,23 @@ struct SearchController {
     void onAllFiles();
     void onGitFiles();
 
+    //! \returns true, if git ls-files lists the files
+    bool inGit() const { return !opts.noGit && fs::exists( opts.path / ".git" ); }
+    //! searches git's files or all files, the daemon and sessions pass their warm thread pool and git file lists
+    void run( server::Warm* warm );
+
     void printHeader();
     void printGitHeader();
     void printStats();
     void printFooter( const StopWatch::ns_type& ms );
 
     void search( const sys_string& path );
+
+    using Walker = std::function<void( const std::function<void( const sys_string& filename )>& onFile )>;
+    static std::atomic_size_t controllers;
+
+    //! searches the files of walker or the warm files in a new or the warm pool
+    void start( const Walker& walker );
+    template<class Pool>
+    void walk( Pool& pool, const Walker& walker );
 };
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "searcher.hpp"
+#include "utils.hpp"
+#include "types.hpp"
+#include "bitap.hpp"
+
+//! regex search for simple patterns like "[Ll]icen[cs]e" or "colou?r"
+struct BitapSearcher : public Searcher {
+    const bitap::Pattern pattern;
+    BitapSearcher( const SearchOptions& opts, const bitap::Pattern& pattern ) : Searcher( opts ), pattern( pattern ) {}
+    virtual void search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) override;
+    virtual size_t count( const std::string_view& content ) override;
+    virtual bool any( const std::string_view& content ) override;
+    virtual ~BitapSearcher() {}
+};
+
+void BitapSearcher::search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) {
+    matches.clear();
+    search::LineScanner scanner( content, lines );
+
+    bitap::find( content, pattern, [this, &matches, &scanner]( size_t from, size_t to ) {
+        matches.emplace_back( from, to );
+        scanner.add( from, to );
+        return proceed( matches.size() );
+    } );
+}
+
+size_t BitapSearcher::count( const std::string_view& content ) {
+    size_t found = 0;
+
+    bitap::find( content, pattern, [this, &found]( size_t, size_t ) {
+        ++found;
+        return proceed( found );
+    } );
+
+    return found;
+}
+
+bool BitapSearcher::any( const std::string_view& content ) {
+    bool found = false;
+
+    bitap::find( content, pattern, [&found]( size_t, size_t ) {
+        found = true;
+        return false;
+    } );
+
+    return found;
+}
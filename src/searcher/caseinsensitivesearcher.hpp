@@ -1,28 +1,117 @@
 #pragma once
 
+#include <algorithm>
+#include <functional>
+
 #include "searcher.hpp"
 #include "utils.hpp"
 #include "types.hpp"
+#include "utf8.hpp"
 
+//! case insensitive search for ASCII terms with strcasestr
+//! terms with letters like i, k or s, which non ASCII letters like İ, K or ſ fold onto,
+//! search non ASCII files with Unicode folding like UnicodeSearcher, so -i k and -i K match the same
 struct CaseInsensitiveSearcher : public Searcher {
-    CaseInsensitiveSearcher( const SearchOptions& opts ) : Searcher( opts ) {}
-    virtual std::vector<search::Match> search( const std::string_view& content ) override;
+    const utf8::Pattern folded; // empty, if no non ASCII letter folds like the term
+    CaseInsensitiveSearcher( const SearchOptions& opts, const utf8::Pattern& folded = {} ) : Searcher( opts ), folded( folded ) {}
+    virtual void search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) override;
+    virtual size_t count( const std::string_view& content ) override;
+    virtual bool any( const std::string_view& content ) override;
     virtual ~CaseInsensitiveSearcher() {}
+
+    //! calls onMatch( from, to ) for each non overlapping match, until it returns false
+    template<typename OnMatch>
+    void find( const std::string_view& content, OnMatch onMatch );
+    //! like find, for binaries with NULs, at which strcasestr stops
+    template<typename OnMatch>
+    void findBinary( const std::string_view& content, OnMatch onMatch );
+
+    //! hash and equality of ASCII case folded bytes
+    struct Folded {
+        inline size_t operator()( const char c ) const { return tolower( static_cast<unsigned char>( c ) ); }
+        inline bool operator()( const char a, const char b ) const { return ( *this )( a ) == ( *this )( b ); }
+    };
 };
 
-std::vector<search::Match> CaseInsensitiveSearcher::search( const std::string_view& content ) {
-    std::vector<search::Match> matches;
+template<typename OnMatch>
+void CaseInsensitiveSearcher::find( const std::string_view& content, OnMatch onMatch ) {
+    if( !folded.positions.empty() && !utf8::isAscii( content ) ) {
+        utf8::find( content, folded, [this, &content, &onMatch]( size_t from, size_t to ) {
+            return ( needsBounds() && !isBounded( content, from, to ) ) || onMatch( from, to );
+        } );
+        return;
+    }
+
+    if( opts.binary ) {
+        findBinary( content, onMatch );
+        return;
+    }
 
-    search::Iter pos = content.cbegin();
     const char* start = content.data();
     const char* ptr = start;
 
     while( ( ptr = strcasestr( ptr, opts.term.data() ) ) ) {
-        search::Iter from = pos + ( ptr - start );
-        search::Iter to = from + opts.term.size();
-        matches.emplace_back( from, to );
+        // skip only one byte, if candidate is not a whole word or line
+        if( needsBounds() && !isBounded( content, ptr - start, ptr - start + opts.term.size() ) ) {
+            ++ptr;
+            continue;
+        }
+
+        if( !onMatch( ptr - start, ptr - start + opts.term.size() ) ) { return; }
+
         ptr += opts.term.size();
     }
+}
+
+template<typename OnMatch>
+void CaseInsensitiveSearcher::findBinary( const std::string_view& content, OnMatch onMatch ) {
+    const std::boyer_moore_horspool_searcher<std::string::const_iterator, Folded, Folded> term( opts.term.cbegin(), opts.term.cend() );
+    const char* start = content.data();
+    const char* end = start + content.size();
+    const char* ptr = start;
+
+    while( ( ptr = std::search( ptr, end, term ) ) != end ) {
+        // skip only one byte, if candidate is not a whole word or line
+        if( needsBounds() && !isBounded( content, ptr - start, ptr - start + opts.term.size() ) ) {
+            ++ptr;
+            continue;
+        }
+
+        if( !onMatch( ptr - start, ptr - start + opts.term.size() ) ) { return; }
+
+        ptr += opts.term.size();
+    }
+}
+
+void CaseInsensitiveSearcher::search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) {
+    matches.clear();
+    search::LineScanner scanner( content, lines );
+
+    find( content, [this, &matches, &scanner]( size_t from, size_t to ) {
+        matches.emplace_back( from, to );
+        scanner.add( from, to );
+        return proceed( matches.size() );
+    } );
+}
+
+size_t CaseInsensitiveSearcher::count( const std::string_view& content ) {
+    size_t found = 0;
+
+    find( content, [this, &found]( size_t, size_t ) {
+        ++found;
+        return proceed( found );
+    } );
+
+    return found;
+}
+
+bool CaseInsensitiveSearcher::any( const std::string_view& content ) {
+    bool found = false;
+
+    find( content, [&found]( size_t, size_t ) {
+        found = true;
+        return false;
+    } );
 
-    return matches;
+    return found;
 }
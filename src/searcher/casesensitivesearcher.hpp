@@ -13,18 +13,36 @@
 
 struct CaseSensitiveSearcher : public Searcher {
     CaseSensitiveSearcher( const SearchOptions& opts ) : Searcher( opts ) {}
-    virtual std::vector<search::Match> search( const std::string_view& content ) override;
+    virtual void search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) override;
+    virtual size_t count( const std::string_view& content ) override;
+    virtual bool any( const std::string_view& content ) override;
     virtual ~CaseSensitiveSearcher() {}
+
+    //! calls onMatch( from, to ) for each non overlapping match, until it returns false
+    template<typename OnMatch>
+    void find( const std::string_view& content, OnMatch onMatch );
 };
 
-std::vector<search::Match> CaseSensitiveSearcher::search( const std::string_view& content ) {
-#if FIND_ALGO == FIND_SSE_OWN
-    return sse::find( content, opts.term );
-#else
+template<typename OnMatch>
+void CaseSensitiveSearcher::find( const std::string_view& content, OnMatch onMatch ) {
+    // binaries have NULs, at which strstr stops, sse::find knows the length
+    if( FIND_ALGO == FIND_SSE_OWN || ( FIND_ALGO == FIND_STRSTR && opts.binary ) ) {
+        size_t last = 0;
+
+        sse::find( content, opts.term, [this, &content, &onMatch, &last]( size_t from, size_t to ) {
+            if( from < last ) { return true; }
+
+            if( needsBounds() && !isBounded( content, from, to ) ) { return true; }
+
+            last = to;
+            return onMatch( from, to );
+        } );
+
+        return;
+    }
 
-    std::vector<search::Match> matches;
+#if FIND_ALGO != FIND_SSE_OWN
 
-    search::Iter pos = content.cbegin();
     const char* start = content.data();
     const char* ptr = start;
     const char* end = start + content.size();
@@ -41,12 +59,54 @@ std::vector<search::Match> CaseSensitiveSearcher::search( const std::string_view
 #endif
 
     {
-        search::Iter from = pos + ( ptr - start );
-        search::Iter to = from + opts.term.size();
-        matches.emplace_back( from, to );
+        // skip only one byte, if candidate is not a whole word or line
+        if( needsBounds() && !isBounded( content, ptr - start, ptr - start + opts.term.size() ) ) {
+            ++ptr;
+            continue;
+        }
+
+        if( !onMatch( ptr - start, ptr - start + opts.term.size() ) ) { return; }
+
         ptr += opts.term.size();
     }
-
-    return matches;
 #endif
 }
+
+void CaseSensitiveSearcher::search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) {
+    matches.clear();
+    search::LineScanner scanner( content, lines );
+
+    find( content, [this, &matches, &scanner]( size_t from, size_t to ) {
+        matches.emplace_back( from, to );
+        scanner.add( from, to );
+        return proceed( matches.size() );
+    } );
+}
+
+size_t CaseSensitiveSearcher::count( const std::string_view& content ) {
+    // single chars don't overlap
+    if( opts.term.size() == 1 && !needsBounds() ) {
+        const size_t found = sse::count( content, opts.term[0] );
+        return limit ? std::min( found, limit ) : found;
+    }
+
+    size_t found = 0;
+
+    find( content, [this, &found]( size_t, size_t ) {
+        ++found;
+        return proceed( found );
+    } );
+
+    return found;
+}
+
+bool CaseSensitiveSearcher::any( const std::string_view& content ) {
+    bool found = false;
+
+    find( content, [&found]( size_t, size_t ) {
+        found = true;
+        return false;
+    } );
+
+    return found;
+}
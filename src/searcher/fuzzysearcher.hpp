@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+
+#include "searcher.hpp"
+#include "utils.hpp"
+#include "types.hpp"
+#include "stdstr.hpp"
+#include "myers.hpp"
+
+//! approximate search with max opts.errors edits
+struct FuzzySearcher : public Searcher {
+    //! exact piece of the term with its offset
+    struct Piece {
+        std::string term;
+        size_t offset = 0;
+    };
+
+    myers::Pattern pattern;
+    std::vector<Piece> pieces;
+    std::vector<std::pair<size_t, size_t>> windows;
+
+    FuzzySearcher( const SearchOptions& opts );
+    virtual void search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) override;
+    virtual size_t count( const std::string_view& content ) override;
+    virtual bool any( const std::string_view& content ) override;
+    //! calls onMatch( from, to ) for each match, until it returns false
+    void find( const std::string_view& content, const std::function<bool( size_t from, size_t to )>& onMatch );
+    virtual ~FuzzySearcher() {}
+};
+
+FuzzySearcher::FuzzySearcher( const SearchOptions& opts ) : Searcher( opts ) {
+    myers::compile( opts.term, opts.ignoreCase, pattern );
+
+    // pigeonhole: a match with k edits contains one of k+1 pieces exactly
+    const size_t count = opts.errors + 1;
+    const size_t length = opts.term.size() / count;
+
+    // short pieces hit everywhere, then scanning all is faster
+    if( opts.ignoreCase || length < 3 ) { return; }
+
+    for( size_t i = 0; i < count; ++i ) {
+        const size_t offset = i * length;
+        const size_t size = i + 1 == count ? opts.term.size() - offset : length;
+        pieces.push_back( {opts.term.substr( offset, size ), offset} );
+    }
+}
+
+void FuzzySearcher::search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) {
+    matches.clear();
+    search::LineScanner scanner( content, lines );
+
+    find( content, [this, &matches, &scanner]( size_t from, size_t to ) {
+        matches.emplace_back( from, to );
+        scanner.add( from, to );
+        return proceed( matches.size() );
+    } );
+}
+
+size_t FuzzySearcher::count( const std::string_view& content ) {
+    size_t found = 0;
+
+    find( content, [this, &found]( size_t, size_t ) {
+        ++found;
+        return proceed( found );
+    } );
+
+    return found;
+}
+
+void FuzzySearcher::find( const std::string_view& content, const std::function<bool( size_t from, size_t to )>& onMatch ) {
+    if( pieces.empty() ) {
+        myers::find( content, 0, content.size(), pattern, opts.errors, onMatch );
+        return;
+    }
+
+    // collect windows around exact pieces, which may contain a match
+    windows.clear();
+    const char* data = content.data();
+    const size_t size = content.size();
+    const size_t errors = opts.errors;
+
+    for( const Piece& piece : pieces ) {
+        const char* ptr = data;
+
+        while( ( ptr = fromStd::strstr( ptr, size - ( ptr - data ), piece.term.data(), piece.term.size() ) ) ) {
+            const size_t pos = ptr - data;
+            const size_t from = pos > piece.offset + errors ? pos - piece.offset - errors : 0;
+            const size_t to = std::min( size, pos + opts.term.size() + errors - piece.offset );
+            windows.emplace_back( from, to );
+            ++ptr;
+        }
+    }
+
+    if( windows.empty() ) { return; }
+
+    // merge overlapping windows and verify them
+    std::sort( windows.begin(), windows.end() );
+    std::pair<size_t, size_t> current = windows.front();
+    bool stopped = false;
+
+    auto onWindowMatch = [&onMatch, &stopped]( size_t from, size_t to ) {
+        stopped = !onMatch( from, to );
+        return !stopped;
+    };
+
+    for( const std::pair<size_t, size_t>& window : windows ) {
+        if( window.first <= current.second ) {
+            current.second = std::max( current.second, window.second );
+        } else {
+            myers::find( content, current.first, current.second, pattern, errors, onWindowMatch );
+
+            if( stopped ) { return; }
+
+            current = window;
+        }
+    }
+
+    myers::find( content, current.first, current.second, pattern, errors, onWindowMatch );
+}
+
+bool FuzzySearcher::any( const std::string_view& content ) {
+    bool found = false;
+
+    find( content, [&found]( size_t, size_t ) {
+        found = true;
+        return false;
+    } );
+
+    return found;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "searcher.hpp"
+#include "ssefind.hpp"
+
+//! case sensitive search with a kernel compiled once for the term
+//! \note Kernel is sse::ShortKernel<N> for 2 to 16 bytes or sse::LongKernel, picked once per run by searcherfactory
+template<typename Kernel>
+struct KernelSearcher : public Searcher {
+    Kernel kernel;
+
+    KernelSearcher( const SearchOptions& opts ) : Searcher( opts ), kernel( opts.term ) {}
+    virtual void search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) override;
+    virtual size_t count( const std::string_view& content ) override;
+    virtual bool any( const std::string_view& content ) override;
+    virtual ~KernelSearcher() {}
+
+    //! calls onMatch( from, to ) for each non overlapping match, until it returns false
+    template<typename OnMatch>
+    void find( const std::string_view& content, OnMatch onMatch );
+};
+
+template<typename Kernel>
+template<typename OnMatch>
+void KernelSearcher<Kernel>::find( const std::string_view& content, OnMatch onMatch ) {
+    size_t last = 0;
+
+    kernel.find( content, [this, &content, &onMatch, &last]( size_t from, size_t to ) {
+        if( from < last ) { return true; }
+
+        if( needsBounds() && !isBounded( content, from, to ) ) { return true; }
+
+        last = to;
+        return onMatch( from, to );
+    } );
+}
+
+template<typename Kernel>
+void KernelSearcher<Kernel>::search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) {
+    matches.clear();
+    search::LineScanner scanner( content, lines );
+
+    find( content, [this, &matches, &scanner]( size_t from, size_t to ) {
+        matches.emplace_back( from, to );
+        scanner.add( from, to );
+        return proceed( matches.size() );
+    } );
+}
+
+template<typename Kernel>
+size_t KernelSearcher<Kernel>::count( const std::string_view& content ) {
+    size_t found = 0;
+
+    find( content, [this, &found]( size_t, size_t ) {
+        ++found;
+        return proceed( found );
+    } );
+
+    return found;
+}
+
+template<typename Kernel>
+bool KernelSearcher<Kernel>::any( const std::string_view& content ) {
+    bool found = false;
+
+    find( content, [&found]( size_t, size_t ) {
+        found = true;
+        return false;
+    } );
+
+    return found;
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#if WITH_PCRE2
+
+#include "searcher.hpp"
+#include "utils.hpp"
+#include "types.hpp"
+#include "stopwatch.hpp"
+
+#include "pcre2.h"
+
+//! regex search with pcre2's JIT
+//! \note every thread has its own searcher, so match data, context and JIT stack are per thread
+struct Pcre2Searcher : public Searcher {
+    pcre2_code* code = nullptr;
+    pcre2_match_data* data = nullptr;
+    pcre2_match_context* context = nullptr;
+    pcre2_jit_stack* stack = nullptr;
+    bool jit = false;
+
+    //! leaves code empty on invalid regexes, see searcherfactory::searcherFunc
+    Pcre2Searcher( const SearchOptions& opts );
+    virtual void search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) override;
+    virtual size_t count( const std::string_view& content ) override;
+    virtual bool any( const std::string_view& content ) override;
+    virtual ~Pcre2Searcher();
+
+    //! calls onMatch( from, to ) for each match, until it returns false
+    //! sets skipped on errors or if budget is exceeded
+    template<typename OnMatch>
+    void find( const std::string_view& content, OnMatch onMatch );
+};
+
+Pcre2Searcher::Pcre2Searcher( const SearchOptions& opts ) : Searcher( opts ) {
+    // like boost::regex' perl syntax, ^ and $ match at newlines
+    uint32_t flags = PCRE2_MULTILINE;
+
+    if( opts.ignoreCase ) { flags |= PCRE2_CASELESS; }
+
+    int error = 0;
+    PCRE2_SIZE offset = 0;
+    const std::string term = opts.regexTerm();
+    code = pcre2_compile( ( PCRE2_SPTR )term.data(), term.size(), flags, &error, &offset, nullptr );
+
+    if( !code ) {
+        PCRE2_UCHAR message[256] = {};
+        pcre2_get_error_message( error, message, sizeof( message ) );
+        LOG( "Invalid regex: " << ( const char* )message << " at offset " << offset );
+        return;
+    }
+
+    // JIT is not available on all platforms, fall back to the interpreter then
+    jit = pcre2_jit_compile( code, PCRE2_JIT_COMPLETE ) == 0;
+
+    data = pcre2_match_data_create_from_pattern( code, nullptr );
+    context = pcre2_match_context_create( nullptr );
+
+    if( jit ) {
+        stack = pcre2_jit_stack_create( 32_kB, 1_MB, nullptr );
+        pcre2_jit_stack_assign( context, nullptr, stack );
+    }
+
+    // bound single matches by the budget, too, roughly 100k backtracks per ms
+    if( opts.timeout ) {
+        const uint32_t limit = static_cast<uint32_t>( std::min<size_t>( opts.timeout * 100000, UINT32_MAX ) );
+        pcre2_set_match_limit( context, limit );
+        pcre2_set_depth_limit( context, limit );
+    }
+}
+
+Pcre2Searcher::~Pcre2Searcher() {
+    pcre2_jit_stack_free( stack );
+    pcre2_match_context_free( context );
+    pcre2_match_data_free( data );
+    pcre2_code_free( code );
+}
+
+template<typename OnMatch>
+void Pcre2Searcher::find( const std::string_view& content, OnMatch onMatch ) {
+    skipped = false;
+
+    StopWatch budget;
+    budget.start();
+    const StopWatch::ns_type limit = opts.timeout * 1000000;
+
+    PCRE2_SPTR subject = ( PCRE2_SPTR )content.data();
+    const PCRE2_SIZE size = content.size();
+    PCRE2_SIZE offset = 0;
+
+    while( offset <= size ) {
+        int rc = jit ?
+                 pcre2_jit_match( code, subject, size, offset, 0, data, context ) :
+                 pcre2_match( code, subject, size, offset, 0, data, context );
+
+        // no more matches
+        if( rc == PCRE2_ERROR_NOMATCH ) { break; }
+
+        // match or depth limit from the budget exceeded, e.g. on catastrophic backtracking
+        if( rc < 0 ) {
+            skipped = true;
+            break;
+        }
+
+        const PCRE2_SIZE* ovector = pcre2_get_ovector_pointer( data );
+        if( !onMatch( ovector[0], ovector[1] ) ) { break; }
+
+        // step over empty matches
+        offset = ovector[1] > ovector[0] ? ovector[1] : ovector[1] + 1;
+
+        if( limit && budget.stop() > limit ) [[unlikely]] {
+            skipped = true;
+            break;
+        }
+    }
+}
+
+void Pcre2Searcher::search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) {
+    matches.clear();
+    search::LineScanner scanner( content, lines );
+
+    find( content, [this, &matches, &scanner]( size_t from, size_t to ) {
+        matches.emplace_back( from, to );
+        scanner.add( from, to );
+        return proceed( matches.size() );
+    } );
+}
+
+size_t Pcre2Searcher::count( const std::string_view& content ) {
+    size_t found = 0;
+
+    find( content, [this, &found]( size_t, size_t ) {
+        ++found;
+        return proceed( found );
+    } );
+
+    return found;
+}
+
+bool Pcre2Searcher::any( const std::string_view& content ) {
+    bool found = false;
+
+    find( content, [&found]( size_t, size_t ) {
+        found = true;
+        return false;
+    } );
+
+    return found;
+}
+
+#endif // WITH_PCRE2
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <memory>
+#include <algorithm>
+#include <functional>
+
+#include "searcher.hpp"
+#include "query.hpp"
+
+//! evaluates opts.query on a file with one searcher per leaf
+//! leaves run cheapest first and stop as soon as the outcome is decided, e.g. at the first missing leaf of an AND
+//! matches are the merged matches of all leaves, which are not negated
+struct QuerySearcher : public Searcher {
+    std::vector<std::unique_ptr<Searcher>> leaves; // by query::Node::leaf
+    std::vector<const query::Node*> positives;     // leaves and near nodes, whose matches are printed
+    search::Matches found;  // of one leaf
+    search::Matches merged; // for count
+    search::Lines ignored;
+    search::Matches nearMatches[2]; // of the two leaves of a near node
+    search::Lines nearLines[2];
+    std::vector<search::Offset> numbers[2]; // line numbers of nearMatches
+
+    QuerySearcher( const SearchOptions& opts, const std::vector<std::function<Searcher*()>>& makeLeaves );
+    virtual void search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) override;
+    virtual size_t count( const std::string_view& content ) override;
+    virtual bool any( const std::string_view& content ) override;
+    virtual ~QuerySearcher() {}
+
+    //! \returns true, if content fulfills node
+    bool evaluate( const query::Node& node, const std::string_view& content );
+    //! collects positive leaves, which are not below a NOT
+    void collectPositives( const query::Node& node, const bool negated );
+    //! fills matches with the matches of both leaves of node, which are within node.distance lines of the other leaf
+    //! both match lists are ascending, so they are merged by line number in linear time
+    void near( const query::Node& node, const std::string_view& content, search::Matches& matches );
+    //! fills matches with sorted, non overlapping matches of the positive leaves
+    void merge( const std::string_view& content, search::Matches& matches );
+};
+
+QuerySearcher::QuerySearcher( const SearchOptions& opts, const std::vector<std::function<Searcher*()>>& makeLeaves ) : Searcher( opts ) {
+    for( const std::function<Searcher*()>& makeLeaf : makeLeaves ) {
+        leaves.emplace_back( makeLeaf() );
+    }
+
+    collectPositives( opts.query, false );
+}
+
+void QuerySearcher::collectPositives( const query::Node& node, const bool negated ) {
+    if( node.type == query::Node::Type::Leaf || node.type == query::Node::Type::Near ) {
+        if( !negated ) { positives.push_back( &node ); }
+
+        return;
+    }
+
+    for( const query::Node& child : node.children ) {
+        collectPositives( child, negated != ( node.type == query::Node::Type::Not ) );
+    }
+}
+
+bool QuerySearcher::evaluate( const query::Node& node, const std::string_view& content ) {
+    switch( node.type ) {
+        case query::Node::Type::Leaf: {
+            Searcher* leaf = leaves[node.leaf].get();
+            leaf->cancelled = cancelled;
+            const bool found = leaf->any( content );
+            skipped |= leaf->skipped;
+            return found;
+        }
+
+        case query::Node::Type::Near:
+            near( node, content, found );
+            return !found.empty();
+
+        case query::Node::Type::Not:
+            return !evaluate( node.children.front(), content );
+
+        case query::Node::Type::And:
+            return std::all_of( node.children.cbegin(), node.children.cend(), [this, &content]( const query::Node & child ) {
+                return evaluate( child, content );
+            } );
+
+        case query::Node::Type::Or:
+            return std::any_of( node.children.cbegin(), node.children.cend(), [this, &content]( const query::Node & child ) {
+                return evaluate( child, content );
+            } );
+    }
+
+    return false;
+}
+
+void QuerySearcher::near( const query::Node& node, const std::string_view& content, search::Matches& matches ) {
+    matches.clear();
+
+    for( size_t i = 0; i < 2; ++i ) {
+        Searcher* leaf = leaves[node.children[i].leaf].get();
+        leaf->cancelled = cancelled;
+        leaf->search( content, nearMatches[i], nearLines[i] );
+        skipped |= leaf->skipped;
+
+        if( nearMatches[i].empty() ) { return; }
+
+        // line numbers of the matches from the lines, which the searcher found on the fly
+        numbers[i].clear();
+        size_t line = 0;
+
+        for( const search::Match& match : nearMatches[i] ) {
+            while( !( match.from < nearLines[i][line].end ) && line + 1 < nearLines[i].size() ) { ++line; }
+
+            numbers[i].push_back( nearLines[i][line].number );
+        }
+    }
+
+    // keep matches with a match of the other leaf in [number - distance, number + distance]
+    const size_t distance = node.distance;
+
+    for( size_t i = 0; i < 2; ++i ) {
+        const std::vector<search::Offset>& own = numbers[i];
+        const std::vector<search::Offset>& other = numbers[1 - i];
+        size_t j = 0;
+
+        for( size_t k = 0; k < own.size(); ++k ) {
+            while( j < other.size() && other[j] + distance < own[k] ) { ++j; }
+
+            if( j < other.size() && other[j] <= own[k] + distance ) { matches.push_back( nearMatches[i][k] ); }
+        }
+    }
+}
+
+void QuerySearcher::merge( const std::string_view& content, search::Matches& matches ) {
+    matches.clear();
+
+    for( const query::Node* node : positives ) {
+        if( node->type == query::Node::Type::Near ) {
+            near( *node, content, found );
+        } else {
+            Searcher* leaf = leaves[node->leaf].get();
+            leaf->cancelled = cancelled;
+            leaf->search( content, found, ignored );
+            skipped |= leaf->skipped;
+        }
+
+        matches.insert( matches.end(), found.cbegin(), found.cend() );
+    }
+
+    if( positives.size() > 1 || ( !positives.empty() && positives.front()->type == query::Node::Type::Near ) ) {
+        std::sort( matches.begin(), matches.end(), []( const search::Match & a, const search::Match & b ) {
+            return a.from < b.from || ( a.from == b.from && a.to > b.to );
+        } );
+
+        // drop matches within other matches, e.g. 'foo' in 'foobar'
+        search::Offset last = 0;
+        auto overlaps = [&last]( const search::Match & match ) {
+            if( match.from < last ) { return true; }
+
+            last = match.to;
+            return false;
+        };
+        matches.erase( std::remove_if( matches.begin(), matches.end(), overlaps ), matches.end() );
+    }
+
+    if( limit && matches.size() > limit ) { matches.resize( limit ); }
+}
+
+void QuerySearcher::search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) {
+    skipped = false;
+    matches.clear();
+    search::LineScanner scanner( content, lines );
+
+    if( !evaluate( opts.query, content ) || skipped ) { return; }
+
+    merge( content, matches );
+
+    for( const search::Match& match : matches ) { scanner.add( match.from, match.to ); }
+}
+
+size_t QuerySearcher::count( const std::string_view& content ) {
+    skipped = false;
+
+    if( !evaluate( opts.query, content ) || skipped ) { return 0; }
+
+    merge( content, merged );
+    return merged.size();
+}
+
+bool QuerySearcher::any( const std::string_view& content ) {
+    skipped = false;
+    return evaluate( opts.query, content );
+}
@@ -3,27 +3,144 @@
 #include "searcher.hpp"
 #include "utils.hpp"
 #include "types.hpp"
+#include "stopwatch.hpp"
+
+//! char iterator for boost::regex, which checks the budget every 16k steps,
+//! so searches, which run long w/out a match, stop, too, w/out cutting the content
+class BudgetIterator {
+    public:
+        //! thrown, once the budget is exceeded
+        struct Exceeded {};
+        struct Budget {
+            StopWatch watch;
+            StopWatch::ns_type limit = 0;
+            unsigned steps = 0;
+
+            void check() const {
+                if( watch.stop() > limit ) { throw Exceeded(); }
+            }
+        };
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = char;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const char*;
+        using reference = const char&;
+
+        BudgetIterator() = default;
+        BudgetIterator( const char* ptr, Budget* budget ) : ptr( ptr ), budget( budget ) {}
+
+        inline reference operator*() const { return *ptr; }
+        inline reference operator[]( const difference_type n ) const { return ptr[n]; }
+        inline BudgetIterator& operator++() {
+            if( !( ++budget->steps & 0x3fff ) ) [[unlikely]] { budget->check(); }
+
+            ++ptr;
+            return *this;
+        }
+        inline BudgetIterator& operator--() { --ptr; return *this; }
+        inline BudgetIterator operator++( int ) { BudgetIterator copy = *this; ++*this; return copy; }
+        inline BudgetIterator operator--( int ) { BudgetIterator copy = *this; --ptr; return copy; }
+        inline BudgetIterator& operator+=( const difference_type n ) { ptr += n; return *this; }
+        inline BudgetIterator& operator-=( const difference_type n ) { ptr -= n; return *this; }
+        inline BudgetIterator operator+( const difference_type n ) const { return BudgetIterator( ptr + n, budget ); }
+        inline BudgetIterator operator-( const difference_type n ) const { return BudgetIterator( ptr - n, budget ); }
+        friend inline BudgetIterator operator+( const difference_type n, const BudgetIterator& it ) { return it + n; }
+        inline difference_type operator-( const BudgetIterator& other ) const { return ptr - other.ptr; }
+        inline bool operator==( const BudgetIterator& other ) const { return ptr == other.ptr; }
+        inline bool operator!=( const BudgetIterator& other ) const { return ptr != other.ptr; }
+        inline bool operator<( const BudgetIterator& other ) const { return ptr < other.ptr; }
+        inline bool operator>( const BudgetIterator& other ) const { return ptr > other.ptr; }
+        inline bool operator<=( const BudgetIterator& other ) const { return ptr <= other.ptr; }
+        inline bool operator>=( const BudgetIterator& other ) const { return ptr >= other.ptr; }
+
+    private:
+        const char* ptr = nullptr;
+        Budget* budget = nullptr;
+};
 
 struct RegexSearcher : public Searcher {
     RegexSearcher( const SearchOptions& opts ) : Searcher( opts ) {}
-    virtual std::vector<search::Match> search( const std::string_view& content ) override;
+    virtual void search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) override;
+    virtual size_t count( const std::string_view& content ) override;
+    virtual bool any( const std::string_view& content ) override;
     virtual ~RegexSearcher() {}
+
+    //! calls onMatch( from, to ) for each match, until it returns false
+    //! sets skipped, if budget is exceeded
+    template<typename OnMatch>
+    void find( const std::string_view& content, OnMatch onMatch );
+
+    //! calls onMatch for each match between begin and end
+    template<typename Iterator, typename OnMatch>
+    void each( const Iterator begin, const Iterator end, const rx::regex_constants::match_flags flags, OnMatch& onMatch );
 };
 
-std::vector<search::Match> RegexSearcher::search( const std::string_view& content ) {
-    std::vector<search::Match> matches;
+template<typename OnMatch>
+void RegexSearcher::find( const std::string_view& content, OnMatch onMatch ) {
+    skipped = false;
 
     // https://www.boost.org/doc/libs/1_70_0/libs/regex/doc/html/boost_regex/ref/match_flag_type.html
-    rx::regex_constants::match_flags flags = rx::regex_constants::match_not_dot_newline;
+    // --multiline lets (?s) override this with no_mod_s
+    rx::regex_constants::match_flags flags = opts.multiline ? rx::regex_constants::match_default : rx::regex_constants::match_not_dot_newline;
+
+    try {
+        if( opts.timeout ) {
+            // the budget iterator is slower than plain pointers, so only searches with a budget use it
+            BudgetIterator::Budget budget;
+            budget.limit = opts.timeout * 1000000;
+            budget.watch.start();
+            each( BudgetIterator( content.data(), &budget ), BudgetIterator( content.data() + content.size(), &budget ), flags, onMatch );
+        } else {
+            each( content.data(), content.data() + content.size(), flags, onMatch );
+        }
+    } catch( const BudgetIterator::Exceeded& ) {
+        skipped = true;
+    }
+    // boost::regex throws, if a match gets too complex, e.g. on catastrophic backtracking
+    catch( const std::runtime_error& ) {
+        skipped = true;
+    }
+}
 
-    auto begin = rx::cregex_iterator( &content.front(), 1 + &content.back(), opts.regex, flags );
-    auto end   = rx::cregex_iterator();
+template<typename Iterator, typename OnMatch>
+void RegexSearcher::each( const Iterator begin, const Iterator end, const rx::regex_constants::match_flags flags, OnMatch& onMatch ) {
+    for( rx::regex_iterator<Iterator> match( begin, end, opts.regex, flags ), last; match != last; ++match ) {
+        const size_t position = match->position();
 
-    for( rx::cregex_iterator match = begin; match != end; ++match ) {
-        search::Iter from = content.cbegin() + match->position();
-        search::Iter to = from + match->length();
-        matches.emplace_back( from, to );
+        if( !onMatch( position, position + match->length() ) ) { return; }
     }
+}
+
+void RegexSearcher::search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) {
+    matches.clear();
+    search::LineScanner scanner( content, lines );
+
+    find( content, [this, &matches, &scanner]( size_t from, size_t to ) {
+        matches.emplace_back( from, to );
+        scanner.add( from, to );
+        return proceed( matches.size() );
+    } );
+}
+
+size_t RegexSearcher::count( const std::string_view& content ) {
+    size_t found = 0;
+
+    find( content, [this, &found]( size_t, size_t ) {
+        ++found;
+        return proceed( found );
+    } );
+
+    return found;
+}
+
+bool RegexSearcher::any( const std::string_view& content ) {
+    bool found = false;
+
+    find( content, [&found]( size_t, size_t ) {
+        found = true;
+        return false;
+    } );
 
-    return matches;
+    return found;
 }
@@ -1,14 +1,60 @@
 #pragma once
 
+#include <cctype>
+#include <atomic>
 #include <vector>
 #include <string_view>
 
 #include "types.hpp"
+#include "linescanner.hpp"
 #include "searchoptions.hpp"
 
 struct Searcher {
     const SearchOptions& opts;
+    bool skipped = false; // true, if the last search exceeded its budget
+    size_t limit = 0;     // max matches per search for --max-count, 0 is unlimited
+    const std::atomic_bool* cancelled = nullptr; // stops all searches, if set
     Searcher( const SearchOptions& opts ) : opts( opts ) {}
-    virtual std::vector<search::Match> search( const std::string_view& content ) = 0;
+    //! fills matches and their lines, which the caller owns and reuses for all files
+    virtual void search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) = 0;
+    //! \returns number of matches w/out collecting them
+    virtual size_t count( const std::string_view& content ) = 0;
+    //! \returns true at the first match, e.g. for --files
+    virtual bool any( const std::string_view& content ) = 0;
     virtual ~Searcher() {}
+
+    //! bytes of UTF-8 sequences count as word chars, so umlauts don't split words
+    static inline bool isWord( const char c ) {
+        const unsigned char u = static_cast<unsigned char>( c );
+        return u >= 0x80 || isalnum( u ) || c == '_';
+    }
+
+    //! \returns true, if match [from, to) in content fulfills --word and --line
+    inline bool isBounded( const std::string_view& content, const size_t from, const size_t to ) const {
+        const size_t size = content.size();
+
+        if( opts.wholeWord ) {
+            if( from != 0 && isWord( content[from - 1] ) ) { return false; }
+
+            if( to != size && isWord( content[to] ) ) { return false; }
+        }
+
+        if( opts.wholeLine ) {
+            if( from != 0 && content[from - 1] != '\n' ) { return false; }
+
+            if( to != size && content[to] != '\n' && !( content[to] == '\r' && to + 1 != size && content[to + 1] == '\n' ) ) { return false; }
+        }
+
+        return true;
+    }
+
+    //! \returns false, if search should stop after found matches
+    inline bool proceed( const size_t found ) const {
+        return !( limit && found >= limit ) && !( cancelled && *cancelled );
+    }
+
+    //! true, if candidates need a check with isBounded
+    inline bool needsBounds() const {
+        return opts.wholeWord || opts.wholeLine;
+    }
 };
@@ -1,38 +1,165 @@
 #pragma once
 
+#include <deque>
+
 #include "regexsearcher.hpp"
+#include "pcre2searcher.hpp"
+#include "bitapsearcher.hpp"
+#include "fuzzysearcher.hpp"
 #include "casesensitivesearcher.hpp"
 #include "caseinsensitivesearcher.hpp"
+#include "unicodesearcher.hpp"
+#include "kernelsearcher.hpp"
+#include "querysearcher.hpp"
 #include "searchoptions.hpp"
 
 namespace searcherfactory {
 
+//! \returns factory of the KernelSearcher with a ShortKernel for the size of term, from N up to 16 bytes
+template<size_t N>
+std::function<Searcher*()> shortTermFunc( SearchOptions& opts ) {
+    if constexpr( N <= SSE128 ) {
+        if( opts.term.size() == N ) {
+            return [&opts] {
+                KernelSearcher<sse::ShortKernel<N>>* searcher = new KernelSearcher<sse::ShortKernel<N>>( opts );
+                return searcher;
+            };
+        }
+
+        return shortTermFunc<N + 1>( opts );
+    } else {
+        return nullptr;
+    }
+}
+
+//! \returns empty function, if the term is an invalid regex
+std::function<Searcher*()> searcherFunc( SearchOptions& opts );
+
+//! \returns factory of a QuerySearcher with a searcher per leaf of opts.query
+//! \note leaves pick their searchers like single terms, so /regexes/ go to bitap, literals to the kernels
+std::function<Searcher*()> queryFunc( SearchOptions& opts ) {
+    // options of the leaves need stable addresses for the searchers
+    auto leafOpts = std::make_shared<std::deque<SearchOptions>>();
+    auto makeLeaves = std::make_shared<std::vector<std::function<Searcher*()>>>();
+
+    query::leaves( opts.query, [&opts, &leafOpts, &makeLeaves]( const query::Node & leaf ) {
+        SearchOptions& sub = leafOpts->emplace_back( opts );
+        sub.isQuery = false;
+        sub.query = query::Node();
+        sub.term = leaf.term;
+        sub.isRegex = opts.isRegex || leaf.isRegex;
+
+        if( opts.multiline && !sub.isRegex ) { sub.term = SearchOptions::unescaped( sub.term ); }
+
+        if( makeLeaves->size() <= leaf.leaf ) { makeLeaves->resize( leaf.leaf + 1 ); }
+
+        ( *makeLeaves )[leaf.leaf] = searcherFunc( sub );
+    } );
+
+    for( const std::function<Searcher*()>& makeLeaf : *makeLeaves ) {
+        if( !makeLeaf ) { return nullptr; }
+    }
+
+    return [&opts, leafOpts, makeLeaves] {
+        QuerySearcher* searcher = new QuerySearcher( opts, *makeLeaves );
+        return searcher;
+    };
+}
+
 std::function<Searcher*()> searcherFunc( SearchOptions& opts ) {
 
-    if( opts.isRegex ) {
+    if( opts.isQuery ) {
+        return queryFunc( opts );
+    }
+
+    // --smart-case ignores case only for terms w/out upper case letters
+    if( opts.smartCase && !opts.ignoreCase ) {
+        opts.ignoreCase = !utf8::hasUpper( opts.term, opts.isRegex );
+    }
+
+    if( opts.isFuzzy ) {
         return [&opts] {
-            rx::regex::flag_type flags = rx::regex::normal;
+            FuzzySearcher* searcher = new FuzzySearcher( opts );
+            return searcher;
+        };
+    }
 
-            if( opts.ignoreCase ) { flags ^= rx::regex::icase; }
+#if WITH_PCRE2
 
-            try {
-                opts.regex.assign( opts.term, flags );
-            } catch( const rx::regex_error& e ) {
-                LOG( "Invalid regex: " << e.what() );
-                exit( EXIT_FAILURE );
-            }
+    if( opts.isRegex && opts.engine == Engine::Pcre2 ) {
+        // each thread compiles its own code, this one checks the term
+        if( !Pcre2Searcher( opts ).code ) { return nullptr; }
 
+        return [&opts] {
+            Pcre2Searcher* searcher = new Pcre2Searcher( opts );
+            return searcher;
+        };
+    }
+
+#endif
+
+    // route simple patterns to bitap
+    bitap::Pattern pattern;
+
+    if( opts.isRegex && opts.engine == Engine::Auto && bitap::compile( opts.regexTerm(), opts.ignoreCase, pattern ) ) {
+        return [&opts, pattern] {
+            BitapSearcher* searcher = new BitapSearcher( opts, pattern );
+            return searcher;
+        };
+    }
+
+    if( opts.isRegex ) {
+        rx::regex::flag_type flags = rx::regex::normal;
+
+        if( opts.ignoreCase ) { flags ^= rx::regex::icase; }
+
+        // like pcre2, . matches newlines only with (?s)
+        if( opts.multiline ) { flags |= rx::regex::no_mod_s; }
+
+        // compile once, the searchers of all threads share it
+        try {
+            opts.regex.assign( opts.regexTerm(), flags );
+        } catch( const rx::regex_error& e ) {
+            LOG( "Invalid regex: " << e.what() );
+            return nullptr;
+        }
+
+        return [&opts] {
             RegexSearcher* searcher = new RegexSearcher( opts );
             return searcher;
         };
     }
 
+    // fold non ASCII terms with Unicode rules, ASCII terms with strcasestr, and in non ASCII files like non ASCII terms
+    utf8::Pattern folded;
+
+    if( opts.ignoreCase && !utf8::isAscii( opts.term ) && utf8::compile( opts.term, folded ) ) {
+        return [&opts, folded] {
+            UnicodeSearcher* searcher = new UnicodeSearcher( opts, folded );
+            return searcher;
+        };
+    }
+
     if( opts.ignoreCase ) {
-        return [&opts] {
-            CaseInsensitiveSearcher* searcher = new CaseInsensitiveSearcher( opts );
+        if( !utf8::compile( opts.term, folded ) || !utf8::hasNonAscii( folded ) ) { folded = utf8::Pattern(); }
+
+        return [&opts, folded] {
+            CaseInsensitiveSearcher* searcher = new CaseInsensitiveSearcher( opts, folded );
             return searcher;
         };
+    }
+
+    // short terms, e.g. identifiers, get a kernel specialised for their size
+    if( opts.term.size() >= 2 && opts.term.size() <= SSE128 ) {
+        return shortTermFunc<2>( opts );
+    }
 
+    // long terms skip with Horspool
+    if( opts.term.size() > SSE128 ) {
+        return [&opts] {
+            KernelSearcher<sse::LongKernel>* searcher = new KernelSearcher<sse::LongKernel>( opts );
+            return searcher;
+        };
     }
 
     return [&opts] {
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "searcher.hpp"
+#include "utils.hpp"
+#include "types.hpp"
+#include "utf8.hpp"
+
+//! case insensitive search for non ASCII terms like "Größe" or "İstanbul"
+struct UnicodeSearcher : public Searcher {
+    const utf8::Pattern pattern;
+    UnicodeSearcher( const SearchOptions& opts, const utf8::Pattern& pattern ) : Searcher( opts ), pattern( pattern ) {}
+    virtual void search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) override;
+    virtual size_t count( const std::string_view& content ) override;
+    virtual bool any( const std::string_view& content ) override;
+    virtual ~UnicodeSearcher() {}
+
+    //! calls onMatch( from, to ) for each match with --word and --line bounds, until it returns false
+    void find( const std::string_view& content, const std::function<bool( size_t from, size_t to )>& onMatch );
+};
+
+void UnicodeSearcher::find( const std::string_view& content, const std::function<bool( size_t from, size_t to )>& onMatch ) {
+    if( !needsBounds() ) {
+        utf8::find( content, pattern, onMatch );
+        return;
+    }
+
+    utf8::find( content, pattern, [this, &content, &onMatch]( size_t from, size_t to ) {
+        return !isBounded( content, from, to ) || onMatch( from, to );
+    } );
+}
+
+void UnicodeSearcher::search( const std::string_view& content, search::Matches& matches, search::Lines& lines ) {
+    matches.clear();
+    search::LineScanner scanner( content, lines );
+
+    find( content, [this, &matches, &scanner]( size_t from, size_t to ) {
+        matches.emplace_back( from, to );
+        scanner.add( from, to );
+        return proceed( matches.size() );
+    } );
+}
+
+size_t UnicodeSearcher::count( const std::string_view& content ) {
+    size_t found = 0;
+
+    find( content, [this, &found]( size_t, size_t ) {
+        ++found;
+        return proceed( found );
+    } );
+
+    return found;
+}
+
+bool UnicodeSearcher::any( const std::string_view& content ) {
+    bool found = false;
+
+    find( content, [&found]( size_t, size_t ) {
+        found = true;
+        return false;
+    } );
+
+    return found;
+}
@@ -17,25 +17,45 @@ SearchOptions SearchOptions::parseArgs( int argc, char* argv[] ) {
 
     po::options_description desc( "Options" );
     desc.add_options()
+    ( "binary", "Search binaries, too, and print byte offsets with hex dumps" )
+    ( "count,c", "Only print number of matches per file" )
+    ( "daemon", "Serve searches in the folder with a warm thread pool and file list, later fsrc calls in it forward to this daemon" )
     ( "dir,d", po::value<std::string>(), "Search folder" )
+    ( "engine", po::value<std::string>(), "Regex engine <arg>, 'auto' (default), 'boost' or 'pcre2'; implies --regex" )
     ( "ext,e", po::value<std::string>(), "Search only in files with extension <arg>, equiv. to --glob '*.ext'" )
+    ( "files,f", "Only print filenames" )
+    ( "fingerprints", "Skip unchanged files, whose cached trigram fingerprints lack the term's trigrams, and cache new ones" )
+    ( "fuzzy", po::value<size_t>(), "Approximate search with max <arg> edits" )
     ( "glob,g", po::value<std::string>(), "Search only in files filtered by <arg> glob, e.g. '*.txt'; overrides --ext" )
     ( "help,h", "Help" )
+    ( "hex", po::value<std::string>(), "Search bytes <arg> in hex, e.g. \"de ad be ef\"; implies --binary" )
     ( "html", "open web page with results" )
     ( "ignore-case,i", "Case insensitive search" )
+    ( "index", "Build or update a trigram index of the folder, which later searches use to skip files" )
+    ( "interactive", "Search each line of stdin as term, a new line cancels the search before it; prints path:line:text and a summary to stderr" )
+    ( "max-count,m", po::value<size_t>(), "Stop after <arg> matches in total" )
+    ( "metadata", "Skip binaries, which a cache of file metadata knows from earlier searches" )
+    ( "multiline,U", "Match across lines; \\n in literal terms is a newline, (?s) lets . match newlines in regexes" )
     ( "no-git", "Disable search with 'git ls-files'" )
+    ( "no-index", "Disable the trigram index" )
     ( "no-colors", "Disable colorized output" )
+    ( "no-daemon", "Search w/out forwarding to a daemon" )
     ( "no-piped", "Disable piped output" )
     ( "no-uri", "Print w/out file:// prefix" )
-    ( "only-files", "Only print filenames" )
     ( "piped", "Enable piped output" )
+    ( "query", "Boolean query of literals, \"quoted literals\" and /regexes/ with & | ! (), and ~n for within n lines, e.g. 'open & !close' or 'lock ~5 return'" )
     ( "quiet,q", "only print status" )
     ( "regex,r", "Regex search (slower)" )
+    ( "smart-case,S", "Case insensitive search, if term is all lower case" )
+    ( "timeout", po::value<size_t>(), "Skip files, on which a regex search needs more than <arg> ms" )
+    ( "word,w", "Match only whole words" )
+    ( "line,x", "Match only whole lines" )
     ;
 
     po::options_description hidden( "Hidden options" );
     hidden.add_options()
-    ( "term,t", po::value<std::string>()->required(), "Search term" );
+    ( "term,t", po::value<std::string>()->required(), "Search term" )
+    ( "stdout", po::value<std::string>(), "'tty' or 'pipe', the daemon gets it from its client" );
 
     po::positional_options_description last;
     last.add( "term", -1 );
@@ -89,6 +109,27 @@ SearchOptions SearchOptions::parseArgs( int argc, char* argv[] ) {
         opts.noGit = true;
     }
 
+    // skip files by their fingerprints
+    if( args.count( "fingerprints" ) ) {
+        opts.fingerprints = true;
+    }
+
+    // skip binaries by their metadata
+    if( args.count( "metadata" ) ) {
+        opts.metadata = true;
+    }
+
+    // disable trigram index
+    if( args.count( "no-index" ) ) {
+        opts.noIndex = true;
+    }
+
+    // output type of the daemon's client
+    if( args.count( "stdout" ) ) {
+        opts.piped = args["stdout"].as<std::string>() != "tty";
+        opts.colorized = !opts.piped;
+    }
+
     // enable piped output
     if( args.count( "piped" ) ) {
         opts.piped = true;
@@ -114,6 +155,10 @@ SearchOptions SearchOptions::parseArgs( int argc, char* argv[] ) {
         opts.quiet = true;
     }
 
+    if( args.count( "count" ) ) {
+        opts.count = true;
+    }
+
     // print results to html
     if( args.count( "html" ) ) {
         opts.html = true;
@@ -124,11 +169,75 @@ SearchOptions SearchOptions::parseArgs( int argc, char* argv[] ) {
         opts.ignoreCase = true;
     }
 
+    // ignore case for lower case terms, resolved in searcherfactory
+    if( args.count( "smart-case" ) ) {
+        opts.smartCase = true;
+    }
+
     // enable regex search
     if( args.count( "regex" ) ) {
         opts.isRegex = true;
     }
 
+    // select regex engine
+    if( args.count( "engine" ) ) {
+        std::string engine = args["engine"].as<std::string>();
+
+        if( engine == "auto" ) {
+            opts.engine = Engine::Auto;
+        } else if( engine == "boost" ) {
+            opts.engine = Engine::Boost;
+        } else if( engine == "pcre2" ) {
+#if WITH_PCRE2
+            opts.engine = Engine::Pcre2;
+#else
+            LOG( "Error  : fsrc was built without pcre2" );
+            return opts;
+#endif
+        } else {
+            LOG( "Error  : unknown regex engine \"" << engine << "\"" );
+            return opts;
+        }
+
+        opts.isRegex = true;
+    }
+
+    // match only whole words
+    if( args.count( "word" ) ) {
+        opts.wholeWord = true;
+    }
+
+    // match only whole lines
+    if( args.count( "line" ) ) {
+        opts.wholeLine = true;
+    }
+
+    // match across lines
+    if( args.count( "multiline" ) ) {
+        opts.multiline = true;
+    }
+
+    // stop after n matches
+    if( args.count( "max-count" ) ) {
+        opts.maxCount = args["max-count"].as<size_t>();
+    }
+
+    // limit regex search time per file
+    if( args.count( "timeout" ) ) {
+        opts.timeout = args["timeout"].as<size_t>();
+    }
+
+    // approximate search
+    if( args.count( "fuzzy" ) ) {
+        opts.isFuzzy = true;
+        opts.errors = args["fuzzy"].as<size_t>();
+    }
+
+    // boolean query, parsed after term
+    if( args.count( "query" ) ) {
+        opts.isQuery = true;
+    }
+
     // filter by extension
     if( args.count( "ext" ) ) {
         opts.glob = "*." + args["ext"].as<std::string>();
@@ -144,6 +253,11 @@ SearchOptions SearchOptions::parseArgs( int argc, char* argv[] ) {
         opts.onlyFiles = true;
     }
 
+    // search binaries
+    if( args.count( "binary" ) ) {
+        opts.binary = true;
+    }
+
     // term
     if( args.count( "term" ) ) {
         opts.term = args["term"].as<std::string>();
@@ -152,6 +266,104 @@ SearchOptions SearchOptions::parseArgs( int argc, char* argv[] ) {
         opts.success = false;
     }
 
+    // term from hex bytes
+    if( args.count( "hex" ) ) {
+        if( args.count( "term" ) ) {
+            LOG( "Error  : --hex replaces the term" );
+            opts.success = false;
+        } else if( opts.isRegex || opts.isFuzzy || opts.isQuery ) {
+            LOG( "Error  : --hex does not work with --regex, --fuzzy or --query" );
+            opts.success = false;
+        } else if( !fromHex( args["hex"].as<std::string>(), opts.term ) ) {
+            LOG( "Error  : invalid hex \"" << args["hex"].as<std::string>() << "\"" );
+            opts.success = false;
+        } else {
+            opts.binary = true;
+            opts.success = true;
+        }
+    }
+
+    // serve searches w/out term
+    if( args.count( "daemon" ) ) {
+        if( args.count( "term" ) ) {
+            LOG( "Error  : --daemon takes no term" );
+            opts.success = false;
+        } else {
+            opts.daemon = true;
+            opts.success = true;
+        }
+    }
+
+    // search terms from stdin
+    if( args.count( "interactive" ) ) {
+        if( args.count( "term" ) ) {
+            LOG( "Error  : --interactive takes no term" );
+            opts.success = false;
+        } else if( args.count( "html" ) || args.count( "daemon" ) ) {
+            LOG( "Error  : --interactive does not work with --html or --daemon" );
+            opts.success = false;
+        } else {
+            opts.interactive = true;
+            opts.success = true;
+        }
+    }
+
+    if( args.count( "no-daemon" ) ) {
+        opts.noDaemon = true;
+    }
+
+    // build index w/out term
+    if( args.count( "index" ) ) {
+        if( args.count( "term" ) ) {
+            LOG( "Error  : --index takes no term" );
+            opts.success = false;
+        } else {
+            opts.buildIndex = true;
+            opts.success = true;
+        }
+    }
+
+    if( opts.success && opts.binary && opts.html ) {
+        LOG( "Error  : --binary does not work with --html" );
+        opts.success = false;
+    }
+
+    if( opts.success && opts.isFuzzy ) {
+        if( opts.isRegex ) {
+            LOG( "Error  : --fuzzy does not work with --regex" );
+            opts.success = false;
+        } else if( opts.wholeWord || opts.wholeLine ) {
+            LOG( "Error  : --fuzzy does not work with --word or --line" );
+            opts.success = false;
+        } else if( opts.term.size() > 64 ) {
+            LOG( "Error  : --fuzzy supports terms with max 64 bytes" );
+            opts.success = false;
+        } else if( opts.errors >= opts.term.size() ) {
+            LOG( "Error  : --fuzzy needs less edits than the term has bytes" );
+            opts.success = false;
+        }
+    }
+
+    // query leaves are unescaped in searcherfactory
+    if( opts.success && opts.multiline && !opts.isRegex && !opts.isQuery ) {
+        opts.term = unescaped( opts.term );
+    }
+
+    if( opts.success && opts.isQuery ) {
+        std::string error;
+
+        if( opts.isFuzzy ) {
+            LOG( "Error  : --fuzzy does not work with --query" );
+            opts.success = false;
+        } else if( !query::parse( opts.term, opts.query, error ) ) {
+            LOG( "Error  : invalid query, " << error );
+            opts.success = false;
+        } else if( query::matchesEmpty( opts.query ) ) {
+            // files match w/out any match to print
+            opts.onlyFiles = true;
+        }
+    }
+
     // help
     if( args.count( "help" ) ) {
         opts.success = false;
@@ -165,3 +377,61 @@ SearchOptions SearchOptions::parseArgs( int argc, char* argv[] ) {
 
     return opts;
 }
+
+std::string SearchOptions::regexTerm() const {
+    std::string bounded = term;
+
+    // same bounds as Searcher::isBounded of the literal searchers, bytes of non ASCII chars are word chars
+    if( wholeWord ) {
+        bounded = "(?<![[:word:]\\x80-\\xff])(?:" + bounded + ")(?![[:word:]\\x80-\\xff])";
+    }
+
+    // and lines end before \n or \r\n
+    if( wholeLine ) {
+        bounded = "(?<![^\\n])(?:" + bounded + ")(?=\\r?\\n|\\z)";
+    }
+
+    return bounded;
+}
+
+bool SearchOptions::fromHex( const std::string& hex, std::string& bytes ) {
+    bytes.clear();
+    std::string digits;
+
+    for( const char c : hex ) {
+        if( isspace( static_cast<unsigned char>( c ) ) ) { continue; }
+
+        if( !isxdigit( static_cast<unsigned char>( c ) ) ) { return false; }
+
+        digits += c;
+    }
+
+    if( digits.empty() || digits.size() % 2 ) { return false; }
+
+    for( size_t i = 0; i < digits.size(); i += 2 ) {
+        bytes += static_cast<char>( std::stoi( digits.substr( i, 2 ), nullptr, 16 ) );
+    }
+
+    return true;
+}
+
+std::string SearchOptions::unescaped( const std::string& term ) {
+    std::string unescaped;
+    unescaped.reserve( term.size() );
+
+    for( size_t i = 0; i < term.size(); ++i ) {
+        if( term[i] == '\\' && i + 1 < term.size() ) {
+            switch( term[i + 1] ) {
+                case 'n': unescaped += '\n'; ++i; continue;
+
+                case 't': unescaped += '\t'; ++i; continue;
+
+                case '\\': unescaped += '\\'; ++i; continue;
+            }
+        }
+
+        unescaped += term[i];
+    }
+
+    return unescaped;
+}
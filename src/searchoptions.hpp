@@ -2,26 +2,59 @@
 
 #include "utils.hpp"
 #include "pipes.hpp"
+#include "query.hpp"
 
 #include "boost/regex.hpp"
 namespace rx = boost;
 
+enum class Engine {
+    Auto,   // bitap for simple patterns, else boost::regex
+    Boost,  // boost::regex
+    Pcre2   // pcre2 with JIT, needs WITH_PCRE2
+};
+
 struct SearchOptions {
     bool success = false;
     bool noGit = false;         // do not use git ls-files
     bool ignoreCase = false;    // case insensitive search
+    bool smartCase = false;     // case insensitive search, if term has no upper case letters
     bool isRegex = false;       // regex search
+    bool isFuzzy = false;       // approximate search
+    bool isQuery = false;       // boolean query of literals and /regexes/
+    bool wholeWord = false;     // match only whole words
+    bool wholeLine = false;     // match only whole lines
+    bool multiline = false;     // match across lines
+    bool binary = false;        // search binaries, too, print byte offsets and hex dumps
+    bool buildIndex = false;    // build trigram index instead of searching
+    bool noIndex = false;       // ignore trigram index
+    bool fingerprints = false;  // skip files by cached trigram fingerprints
+    bool metadata = false;      // skip binaries by cached file metadata
+    bool daemon = false;        // serve searches over a socket
+    bool noDaemon = false;      // search w/out forwarding to a daemon
+    bool interactive = false;   // search terms from stdin, each cancels the previous one
     bool quiet = false;         // print only status
     bool html = false;          // open results as html page
     bool onlyFiles = false;     // print only filenames
+    bool count = false;         // print only number of matches per file
     bool noURI = false;         // print w/out file://
     bool piped = pipes::stdoutIsPipe(); // grep-compatible piped output
     bool colorized = !piped; // show colors
     std::string term;
     std::string glob;
+    Engine engine = Engine::Auto; // regex engine
+    size_t timeout = 0;         // regex budget per file in ms, 0 is unlimited
+    size_t errors = 0;          // max edits for fuzzy search
+    size_t maxCount = 0;        // max matches in total, 0 is unlimited
     rx::regex regex;
+    query::Node query;          // ordered query tree for --query
     fs::path path;
     sys_string pathPrefix;
     operator bool() const { return success; }
+    //! \returns term for regex engines with word and line boundaries
+    std::string regexTerm() const;
+    //! \returns bytes of hex like "de ad be ef" in bytes, false on invalid hex
+    static bool fromHex( const std::string& hex, std::string& bytes );
+    //! \returns literal term with \n, \t and \\ escapes replaced for --multiline
+    static std::string unescaped( const std::string& term );
     static SearchOptions parseArgs( int argc, char* argv[] );
 };
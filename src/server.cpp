@@ -0,0 +1,304 @@
+#include "server.hpp"
+
+#include <set>
+#include <cerrno>
+#include <csignal>
+
+#include "searchoptions.hpp"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#endif
+
+bool server::FileList::valid() const {
+    trigram::Stamp current;
+
+    for( const auto& [path, stamp] : stamps ) {
+        if( !trigram::stamp( path, current ) || current != stamp ) { return false; }
+    }
+
+    return !stamps.empty();
+}
+
+void server::FileList::refresh( const fs::path& repo ) {
+    files.clear();
+    stamps.clear();
+
+    utils::gitLsFiles( repo, [this]( const sys_string & filename ) { files.push_back( filename ); } );
+
+    // new untracked files change the mtime of their folder
+    std::set<sys_string> folders = { toSysString( "." ), toSysString( ".git/index" ) };
+
+    for( const sys_string& filename : files ) {
+        for( fs::path folder = fs::path( filename ).parent_path(); !folder.empty(); folder = folder.parent_path() ) {
+            if( !folders.insert( folder.native() ).second ) { break; }
+        }
+    }
+
+    for( const sys_string& folder : folders ) {
+        trigram::Stamp stamp;
+
+        if( trigram::stamp( folder, stamp ) ) { stamps.emplace_back( folder, stamp ); }
+    }
+}
+
+fs::path server::socket( const fs::path& folder ) {
+    return trigram::location( folder, "fsrc.sock" );
+}
+
+#ifdef _WIN32
+
+bool server::serve( const SearchOptions&, const Search& ) {
+    LOG( "Error  : --daemon needs Unix sockets" );
+    return false;
+}
+
+bool server::forward( const SearchOptions&, int, char**, int& ) {
+    return false;
+}
+
+#else
+
+namespace {
+
+//! socket path for the signal handler
+char listening[sizeof( sockaddr_un::sun_path )] = {};
+
+void onExit() {
+    unlink( listening );
+}
+
+void onSignal( int ) {
+    unlink( listening );
+    _exit( EXIT_SUCCESS );
+}
+
+bool address( const fs::path& path, sockaddr_un& address ) {
+    if( path.native().size() >= sizeof( address.sun_path ) ) {
+        LOG( "Error  : socket path " << path.string() << " is too long" );
+        return false;
+    }
+
+    address = {};
+    address.sun_family = AF_UNIX;
+    strcpy( address.sun_path, path.c_str() );
+    return true;
+}
+
+//! \returns true, if client runs as the same user as the daemon, others must not read its files through it
+bool trusted( const int client ) {
+#ifdef __linux__
+    ucred credentials = {};
+    socklen_t size = sizeof( credentials );
+
+    if( getsockopt( client, SOL_SOCKET, SO_PEERCRED, &credentials, &size ) ) { return false; }
+
+    return credentials.uid == getuid();
+#else
+    uid_t uid = 0;
+    gid_t gid = 0;
+
+    if( getpeereid( client, &uid, &gid ) ) { return false; }
+
+    return uid == getuid();
+#endif
+}
+
+//! \returns true, if folder is root or below it
+bool inside( const fs::path& folder, const fs::path& root ) {
+    boost::system::error_code error;
+    const std::string path = fs::canonical( folder, error ).string();
+
+    if( error ) { return false; }
+
+    return path.compare( 0, root.native().size(), root.native() ) == 0 &&
+           ( path.size() == root.native().size() || path[root.native().size()] == '/' );
+}
+
+//! request: working dir and arguments, each \0 terminated, and a final \0
+bool readRequest( const int client, std::vector<std::string>& request ) {
+    std::string data;
+    char buffer[4096];
+    ssize_t bytes = 0;
+
+    while( ( data.size() < 2 || data.compare( data.size() - 2, 2, std::string( 2, '\0' ) ) ) &&
+            ( bytes = read( client, buffer, sizeof( buffer ) ) ) > 0 ) {
+        data.append( buffer, bytes );
+    }
+
+    // a client, which hung up or stalled, sent an incomplete request
+    if( data.size() < 2 || data.compare( data.size() - 2, 2, std::string( 2, '\0' ) ) ) { return false; }
+
+    for( size_t from = 0, to = 0; ( to = data.find( '\0', from ) ) != std::string::npos && to != from; from = to + 1 ) {
+        request.emplace_back( data.substr( from, to - from ) );
+    }
+
+    return request.size() >= 2;
+}
+
+//! runs the search of request with stdout redirected to client
+//! \returns exit code of the search
+int handle( const int client, const std::vector<std::string>& request, const fs::path& root, const server::Search& search, server::Warm& warm ) {
+    boost::system::error_code error;
+    fs::current_path( request.front(), error );
+
+    if( error ) { return EXIT_FAILURE; }
+
+    fflush( stdout );
+    std::cout.flush();
+    const int saved = dup( STDOUT_FILENO );
+    dup2( client, STDOUT_FILENO );
+
+    std::vector<char*> argv;
+
+    for( size_t i = 1; i < request.size(); ++i ) { argv.push_back( const_cast<char*>( request[i].c_str() ) ); }
+
+    SearchOptions opts = SearchOptions::parseArgs( static_cast<int>( argv.size() ), argv.data() );
+    int status = EXIT_SUCCESS;
+
+    // like main
+    if( !opts ) {
+        status = EXIT_FAILURE;
+    } else if( !fs::is_directory( opts.path ) ) {
+        printf( "\"%s\" is not a directory.\n", opts.path.string().c_str() );
+        status = 255;
+    } else if( !inside( opts.path, root ) ) {
+        LOG( "Error  : the daemon only searches in " << root.string() );
+        status = EXIT_FAILURE;
+    } else {
+        // an invalid regex fails this request only, its message goes to the client
+        status = search( opts, &warm );
+    }
+
+    fflush( stdout );
+    std::cout.flush();
+    dup2( saved, STDOUT_FILENO );
+    close( saved );
+    return status;
+}
+
+}
+
+bool server::serve( const SearchOptions& opts, const Search& search ) {
+    const fs::path path = socket( opts.path );
+    sockaddr_un local;
+
+    if( !address( path, local ) ) { return false; }
+
+    boost::system::error_code error;
+    const fs::path root = fs::canonical( opts.path, error );
+
+    if( error ) { return false; }
+
+    const int fd = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+    unlink( path.c_str() );
+
+    // only the owner may connect, the socket is created w/out permissions for others
+    const mode_t mask = umask( 0077 );
+    const bool bound = fd != -1 && !bind( fd, reinterpret_cast<sockaddr*>( &local ), sizeof( local ) );
+    umask( mask );
+
+    if( !bound || chmod( path.c_str(), S_IRUSR | S_IWUSR ) || listen( fd, 16 ) ) {
+        LOG( "Error  : could not listen on " << path.string() );
+        return false;
+    }
+
+    // remove the socket on exit and survive clients, which hang up early
+    strcpy( listening, path.c_str() );
+    atexit( onExit );
+    signal( SIGINT, onSignal );
+    signal( SIGTERM, onSignal );
+    signal( SIGPIPE, SIG_IGN );
+
+    if( !opts.quiet ) { LOG( "Serving " << opts.path.string() << " on " << path.string() ); }
+
+    Warm warm;
+#if THREADPOOL == OWN_THREADPOOL
+    warm.pool = std::make_unique<ThreadPool>( std::min<size_t>( std::thread::hardware_concurrency(), 8u ) );
+#endif
+
+    for( ;; ) {
+        const int client = accept( fd, nullptr, nullptr );
+
+        if( client == -1 ) {
+            if( errno == EINTR ) { continue; }
+
+            break;
+        }
+
+        std::vector<std::string> request;
+
+        // clients, which stall before their request is complete, don't block the others for long
+        timeval timeout = {};
+        timeout.tv_sec = 2;
+        setsockopt( client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof( timeout ) );
+
+        // the exit code trails the output
+        if( trusted( client ) && readRequest( client, request ) ) {
+            const char status = static_cast<char>( handle( client, request, root, search, warm ) );
+            ssize_t written = write( client, &status, 1 );
+            ( void )written;
+        }
+
+        close( client );
+    }
+
+    unlink( path.c_str() );
+    close( fd );
+    return true;
+}
+
+bool server::forward( const SearchOptions& opts, int argc, char* argv[], int& status ) {
+    const fs::path path = socket( opts.path );
+    sockaddr_un remote;
+
+    // the html printer opens one page per process
+    if( opts.html || !fs::exists( path ) || !address( path, remote ) ) { return false; }
+
+    const int fd = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+
+    if( fd == -1 ) { return false; }
+
+    utils::ScopeGuard onExit( [fd] { close( fd ); } );
+
+    // a daemon, which was killed, leaves its socket
+    if( connect( fd, reinterpret_cast<sockaddr*>( &remote ), sizeof( remote ) ) ) { return false; }
+
+    // the daemon's stdout is the socket, so it gets this one's type behind the program name
+    std::string request = fs::current_path().string() + '\0' + argv[0] + '\0';
+    request += std::string( pipes::stdoutIsPipe() ? "--stdout=pipe" : "--stdout=tty" ) + '\0';
+
+    for( int i = 1; i < argc; ++i ) { request += std::string( argv[i] ) + '\0'; }
+
+    request += '\0';
+
+    for( size_t sent = 0; sent < request.size(); ) {
+        const ssize_t bytes = write( fd, request.data() + sent, request.size() - sent );
+
+        if( bytes <= 0 ) { return false; }
+
+        sent += bytes;
+    }
+
+    // hold back the last byte, the exit code, a daemon, which exited during the search, sends none
+    char buffer[64 * 1024];
+    ssize_t bytes = 0;
+    int last = -1;
+
+    while( ( bytes = read( fd, buffer, sizeof( buffer ) ) ) > 0 ) {
+        if( last != -1 ) { fputc( last, stdout ); }
+
+        fwrite( buffer, 1, bytes - 1, stdout );
+        last = static_cast<unsigned char>( buffer[bytes - 1] );
+    }
+
+    fflush( stdout );
+    status = last != -1 ? last : EXIT_FAILURE;
+    return true;
+}
+
+#endif
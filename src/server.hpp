@@ -0,0 +1,48 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <functional>
+
+#include "threadpool.hpp"
+#include "trigramindex.hpp"
+
+struct SearchOptions;
+
+//! fsrc --daemon serves searches in a folder over a Unix socket with a warm thread pool and git file list
+//! other fsrc calls in that folder forward their arguments to it and print what it streams back
+namespace server {
+
+//! cached output of git ls-files, valid while git's index and the folders of its files are unchanged
+struct FileList {
+    std::vector<sys_string> files;
+    std::vector<std::pair<sys_string, trigram::Stamp>> stamps; // of .git/index and folders, relative to the repo
+
+    //! \returns false, if a file was added, removed or staged since refresh, call it in the repo
+    bool valid() const;
+    void refresh( const fs::path& repo );
+};
+
+//! state, which outlives a search
+struct Warm {
+#if THREADPOOL == OWN_THREADPOOL
+    std::unique_ptr<ThreadPool> pool;
+#endif
+    std::map<fs::path, FileList> lists; // per repo
+};
+
+//! \returns exit code of the search
+using Search = std::function<int( SearchOptions& opts, Warm* warm )>;
+
+//! \returns location of the socket for folder
+fs::path socket( const fs::path& folder );
+
+//! serves searches in opts.path and its subfolders to the same user until it's killed
+//! \returns false, if the socket can't be created
+bool serve( const SearchOptions& opts, const Search& search );
+
+//! sends the arguments to the daemon of opts.path, prints its output and sets status to its exit code
+//! \returns false, if there is no daemon
+bool forward( const SearchOptions& opts, int argc, char* argv[], int& status );
+
+}
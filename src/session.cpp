@@ -0,0 +1,200 @@
+#include "session.hpp"
+
+#include <future>
+#include <iostream>
+
+#include "searchcontroller.hpp"
+#include "printer/streamprinter.hpp"
+
+struct session::Session::Query {
+    SearchOptions opts;
+    OnResult onResult;
+    OnDone onDone;
+    StreamPrinter::OnResult deliver; // counts results before passing them on
+    Summary summary;
+    StopWatch watch;
+    std::atomic_bool superseded = {false};
+    std::mutex m; // guards controller, which the worker creates, against cancel
+    std::unique_ptr<SearchController> controller;
+    std::promise<void> done;
+    std::shared_future<void> finished = done.get_future();
+
+    //! stops walker, pool and searchers, and drops further results
+    void cancel() {
+        superseded = true;
+        std::unique_lock<std::mutex> lock( m );
+
+        if( controller ) { controller->cancelled = true; }
+    }
+};
+
+session::Session::Session( const SearcherFunc& searcherFunc ) : searcherFunc( searcherFunc ) {
+#if THREADPOOL == OWN_THREADPOOL
+    warm.pool = std::make_unique<ThreadPool>( std::min<size_t>( std::thread::hardware_concurrency(), 8u ) );
+#endif
+}
+
+session::Session::~Session() {
+    cancel();
+
+    if( worker.joinable() ) { worker.join(); }
+}
+
+void session::Session::query( const SearchOptions& opts, const OnResult& onResult, const OnDone& onDone ) {
+    std::shared_ptr<Query> next = std::make_shared<Query>();
+    Query* query = next.get();
+    query->watch.start();
+
+    // results go to the callback only, w/out headers and notes on stdout
+    // searches in git repos change the working directory, so later queries can't resolve relative paths
+    query->opts = opts;
+    query->opts.path = utils::absolutePath( opts.path.native() );
+    query->opts.piped = true;
+    query->opts.colorized = false;
+    query->onResult = onResult;
+    query->onDone = onDone;
+    query->summary.term = opts.term;
+
+    query->deliver = [query]( const search::Result & result ) {
+        if( !query->summary.files++ ) { query->summary.firstResult = query->watch.stop() / 1000; }
+
+        query->summary.matches += result.count;
+        query->onResult( result );
+    };
+
+    std::unique_lock<std::mutex> lock( m );
+
+    if( current ) { current->cancel(); }
+
+    current = next;
+
+    // the warm pool serves one query at a time, the cancelled one drains its jobs w/out running them
+    worker = std::thread( [this, next, previous = std::move( worker )]() mutable {
+        if( previous.joinable() ) { previous.join(); }
+
+        run( *next );
+    } );
+}
+
+void session::Session::run( Query& query ) {
+    // searchers and printers refer to the query's options, which outlive the warm threads' use of them
+    std::function<Searcher*()> makeSearcher;
+
+    if( !query.superseded ) {
+        // a half typed regex skips its query, searcherFunc prints why
+        makeSearcher = searcherFunc( query.opts );
+        query.summary.invalid = !makeSearcher;
+    }
+
+    if( makeSearcher ) {
+        std::function<Printer*()> makePrinter = [&query] { return new StreamPrinter( query.opts, query.deliver, query.superseded ); };
+        std::unique_ptr<SearchController> controller = std::make_unique<SearchController>( query.opts, makeSearcher, makePrinter );
+
+        if( controller->inGit() ) { query.opts.pathPrefix = query.opts.path.native(); }
+
+        {
+            std::unique_lock<std::mutex> lock( query.m );
+            query.controller = std::move( controller );
+
+            if( query.superseded ) { query.controller->cancelled = true; }
+        }
+
+        query.controller->run( &warm );
+    }
+
+    query.summary.total = query.watch.stop() / 1000;
+    query.summary.cancelled = query.superseded;
+
+    if( query.onDone ) { query.onDone( query.summary ); }
+
+    query.done.set_value();
+}
+
+void session::Session::cancel() {
+    std::unique_lock<std::mutex> lock( m );
+
+    if( current ) { current->cancel(); }
+}
+
+void session::Session::wait() {
+    std::shared_future<void> finished;
+
+    {
+        std::unique_lock<std::mutex> lock( m );
+
+        if( !current ) { return; }
+
+        finished = current->finished;
+    }
+
+    finished.wait();
+}
+
+void session::interactive( const SearchOptions& opts, int argc, char* argv[], const SearcherFunc& searcherFunc ) {
+    // each line's term goes behind the other arguments
+    std::vector<std::string> args;
+
+    for( int i = 0; i < argc; ++i ) {
+        if( std::string( argv[i] ) != "--interactive" ) { args.emplace_back( argv[i] ); }
+    }
+
+    args.emplace_back( "--term" );
+    args.emplace_back();
+
+    Session session( searcherFunc );
+    std::string line;
+
+    while( std::getline( std::cin, line ) ) {
+        // an empty line only cancels
+        if( line.empty() ) {
+            session.cancel();
+            continue;
+        }
+
+        args.back() = line;
+        std::vector<char*> parsed;
+
+        for( std::string& arg : args ) { parsed.push_back( arg.data() ); }
+
+        SearchOptions query = SearchOptions::parseArgs( static_cast<int>( parsed.size() ), parsed.data() );
+
+        if( !query ) { continue; }
+
+        // the working directory changes with searches in git repos, opts resolved the folder before
+        query.path = opts.path;
+
+        // flush per file, so the reader gets the first results right away
+        session.query( query, [onlyFiles = query.onlyFiles, count = query.count]( const search::Result & result ) {
+            std::string out;
+
+            if( onlyFiles ) {
+                out = result.path + "\n";
+            } else if( count ) {
+                out = utils::format( "%s:%lu\n", result.path.c_str(), result.count );
+            } else {
+                for( const search::Line& match : result.lines ) {
+                    out += utils::format( "%s:%u:", result.path.c_str(), match.number );
+                    out += match.view( result.text );
+                    out += '\n';
+                }
+            }
+
+            fwrite( out.data(), 1, out.size(), stdout );
+            fflush( stdout );
+        }, []( const Summary & summary ) {
+            if( summary.invalid ) {
+                std::cerr << utils::format( "Skipped invalid regex \"%s\"\n", summary.term.c_str() );
+            } else if( summary.cancelled ) {
+                std::cerr << utils::format( "Cancelled \"%s\" after %.1f ms\n", summary.term.c_str(), summary.total / 1000.0 );
+            } else if( !summary.files ) {
+                std::cerr << utils::format( "Found nothing for \"%s\" in %.1f ms\n", summary.term.c_str(), summary.total / 1000.0 );
+            } else {
+                std::cerr << utils::format( "Found %lu matches in %lu files for \"%s\", first after %.1f ms, all in %.1f ms\n",
+                                            summary.matches, summary.files, summary.term.c_str(),
+                                            summary.firstResult / 1000.0, summary.total / 1000.0 );
+            }
+        } );
+    }
+
+    session.wait();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <functional>
+
+#include "types.hpp"
+#include "server.hpp"
+
+struct Searcher;
+struct SearchOptions;
+
+//! embedding API for search as you type, e.g. in an IDE plugin, which queries on every keystroke
+//! each query cancels the one in flight, whose threads stop at their next file or match,
+//! and streams its results file by file through a callback, searched in a warm thread pool and git file list
+namespace session {
+
+//! of one query, times in µs since Session::query
+struct Summary {
+    std::string term;
+    size_t files = 0;            // with matches
+    size_t matches = 0;
+    long long firstResult = -1;  // time to first result, -1 w/out results
+    long long total = 0;
+    bool cancelled = false;      // by a newer query or cancel(), results after it were dropped
+    bool invalid = false;        // regex didn't compile, e.g. a half typed one, and was skipped
+};
+
+using OnResult = std::function<void( const search::Result& result )>;
+using OnDone = std::function<void( const Summary& summary )>;
+//! searcherfactory::searcherFunc, whose header can only be included by one translation unit
+using SearcherFunc = std::function<std::function<Searcher*()>( SearchOptions& opts )>;
+
+class Session {
+    public:
+        Session( const SearcherFunc& searcherFunc );
+        //! cancels the query in flight and waits for its threads
+        ~Session();
+        //! cancels the query in flight and searches opts in the background
+        //! \note onResult runs on pool threads, one call at a time, onDone after the query's last result,
+        //!       and queries run one after another, so callbacks of two queries never interleave
+        //! \note searches in git repos change the working directory like fsrc does, pass absolute paths
+        void query( const SearchOptions& opts, const OnResult& onResult, const OnDone& onDone = {} );
+        //! cancels the query in flight
+        void cancel();
+        //! waits until the last query is done
+        void wait();
+    private:
+        struct Query;
+        void run( Query& query );
+
+        SearcherFunc searcherFunc;
+        server::Warm warm;
+        std::mutex m;
+        std::shared_ptr<Query> current;
+        std::thread worker; // joins the worker of the previous query, then runs current
+};
+
+//! fsrc --interactive reads one term per line from stdin, each line cancels the query before it,
+//! results are printed as path:line:text like grep -n, and a summary per query to stderr
+//! \param opts parsed arguments w/out term
+void interactive( const SearchOptions& opts, int argc, char* argv[], const SearcherFunc& searcherFunc );
+
+}
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <tuple>
 #include <cstring>
 #include <vector>
 #include <emmintrin.h>
@@ -10,8 +14,11 @@
 #define SSE128 16
 
 namespace sse {
-inline std::vector<search::Match> find( const std::string_view& text, const std::string& term ) {
-    std::vector<search::Match> matches;
+
+//! calls onMatch( from, to ) for each, also overlapping, occurrence of term in text, until it returns false
+//! \note text must be 16 byte aligned with 16 bytes padding, like utils::Buffer
+template<typename OnMatch>
+inline void find( const std::string_view& text, const std::string& term, OnMatch onMatch ) {
     const char* start = text.data();
 
     if( term.size() == 1 ) {
@@ -20,14 +27,16 @@ inline std::vector<search::Match> find( const std::string_view& text, const std:
         while( ( pos = static_cast<const char*>( memchr( static_cast<const void*>( pos ),
                                                          term[0],
                                                          text.size() - ( pos - start ) ) ) ) ) {
-            auto iter = text.cbegin() + ( pos - start );
-            matches.emplace_back( iter, iter + 1 );
+            if( !onMatch( pos - start, pos - start + 1 ) ) { return; }
+
             ++pos;
         }
 
-        return matches;
+        return;
     }
 
+    if( text.size() < term.size() ) { return; }
+
     static const __m128i lastOne = _mm_setr_epi8( 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff );
     const __m128i first  = _mm_set1_epi8( term[0] );
     const __m128i second = _mm_set1_epi8( term[1] );
@@ -58,14 +67,324 @@ inline std::vector<search::Match> find( const std::string_view& text, const std:
             const char* pos = start + block * SSE128 + diff - 1;
 
             if( !memcmp( pos + 2, &term[2], term.size() - 2 ) ) {
-                auto iter = text.cbegin() + ( pos - start );
-                matches.emplace_back( iter, iter + term.size() );
+                if( !onMatch( pos - start, pos - start + term.size() ) ) { return; }
             }
 
             mv2 ^= ( 1 << ( diff - 1 ) );
         }
     }
+}
+
+namespace {
+
+//! rough frequency of bytes in source code, from rare to frequent, other bytes are rarer
+static constexpr std::string_view COMMON = "QJXZKVBYWGPFMUCDLHRSNIOATEzqjxkvbywgpfmucdlhrsnioate_.,;()\t\n ";
+
+inline size_t frequency( const char c ) {
+    const size_t pos = COMMON.find( c );
+    return pos == std::string_view::npos ? 0 : pos + 1;
+}
+
+//! \returns positions of two rare and, if possible, different bytes of term, which are filtered first
+inline std::pair<size_t, size_t> rarest( const char* term, const size_t size ) {
+    size_t one = 0;
+
+    for( size_t i = 1; i < size; ++i ) {
+        if( frequency( term[i] ) < frequency( term[one] ) ) { one = i; }
+    }
+
+    // a repeated byte filters nothing
+    auto score = [term, one]( const size_t i ) {
+        return frequency( term[i] ) + ( term[i] == term[one] ? COMMON.size() + 1 : 0 );
+    };
+
+    size_t two = one ? 0 : 1;
+
+    for( size_t i = two + 1; i < size; ++i ) {
+        if( i != one && score( i ) < score( two ) ) { two = i; }
+    }
+
+    return {one, two};
+}
+
+}
+
+//! like find, but for terms of N bytes with 2 <= N <= 16, e.g. short identifiers
+//! filters candidates with the two rarest bytes of term and verifies them with one masked 16 byte compare instead of memcmp
+//! \note reads only within text, no alignment or padding needed
+template<size_t N>
+struct ShortKernel {
+    static_assert( N >= 2 && N <= SSE128, "ShortKernel needs 2 to 16 bytes" );
+    static constexpr int FULL = ( 1 << N ) - 1;
+
+    char term[SSE128] = {};
+    size_t one = 0; // offsets of the anchor bytes in term
+    size_t two = 0;
+    __m128i needle;
+    __m128i first;
+    __m128i second;
+
+    explicit ShortKernel( const std::string& text ) {
+        memcpy( term, text.data(), N );
+        std::tie( one, two ) = rarest( term, N );
+        needle = _mm_loadu_si128( ( __m128i const* )term );
+        first  = _mm_set1_epi8( term[one] );
+        second = _mm_set1_epi8( term[two] );
+    }
+
+    //! \returns compare mask of term starts in the 16 bytes at ptr, where both anchor bytes match
+    inline __m128i candidates( const char* ptr ) const {
+        const __m128i a = _mm_loadu_si128( ( __m128i const* )( ptr + one ) );
+        const __m128i b = _mm_loadu_si128( ( __m128i const* )( ptr + two ) );
+        return _mm_and_si128( _mm_cmpeq_epi8( a, first ), _mm_cmpeq_epi8( b, second ) );
+    }
+
+    //! \returns true, if term starts at ptr
+    inline bool verify( const char* ptr ) const {
+        // both anchor bytes are already verified
+        if constexpr( N == 2 ) { return true; }
+
+        const __m128i candidate = _mm_loadu_si128( ( __m128i const* )ptr );
+        return ( _mm_movemask_epi8( _mm_cmpeq_epi8( candidate, needle ) ) & FULL ) == FULL;
+    }
+
+    //! calls onMatch( from, to ) for each, also overlapping, occurrence of term in text, until it returns false
+    template<typename OnMatch>
+    void find( const std::string_view& text, OnMatch onMatch ) const {
+        const char* data = text.data();
+        const size_t size = text.size();
+        size_t pos = 0;
+
+        auto bits = []( const __m128i mask ) -> uint64_t {
+            return static_cast<unsigned>( _mm_movemask_epi8( mask ) );
+        };
+
+        //! reports verified candidates in mask, which start at pos
+        auto report = [this, data, &onMatch]( const size_t pos, uint64_t mask ) {
+            while( mask ) {
+                const size_t from = pos + std::countr_zero( mask );
+                mask &= mask - 1;
+
+                if( verify( data + from ) && !onMatch( from, from + N ) ) { return false; }
+            }
+
+            return true;
+        };
+
+        // scan 64 bytes per step, loads of the last candidate end before pos + 4 * SSE128 + SSE128
+        for( ; pos + 5 * SSE128 <= size; pos += 4 * SSE128 ) {
+            const char* ptr = data + pos;
+            const __m128i c0 = candidates( ptr );
+            const __m128i c1 = candidates( ptr + SSE128 );
+            const __m128i c2 = candidates( ptr + 2 * SSE128 );
+            const __m128i c3 = candidates( ptr + 3 * SSE128 );
+
+            // most blocks have no candidate at all
+            if( !_mm_movemask_epi8( _mm_or_si128( _mm_or_si128( c0, c1 ), _mm_or_si128( c2, c3 ) ) ) ) { continue; }
+
+            if( !report( pos, bits( c0 ) | bits( c1 ) << SSE128 | bits( c2 ) << 2 * SSE128 | bits( c3 ) << 3 * SSE128 ) ) { return; }
+        }
+
+        // then 16 bytes per step
+        for( ; pos + 2 * SSE128 <= size; pos += SSE128 ) {
+            if( !report( pos, bits( candidates( data + pos ) ) ) ) { return; }
+        }
+
+        for( ; pos + N <= size; ++pos ) {
+            if( data[pos] == term[0] && !memcmp( data + pos, term, N ) ) {
+                if( !onMatch( pos, pos + N ) ) { return; }
+            }
+        }
+    }
+};
+
+//! for terms longer than 16 bytes, e.g. log lines or code snippets
+//! Horspool on hashed byte pairs skips up to size - 1 bytes per window, windows ending on the last pair
+//! of term are verified with 16 byte compares, so search is sublinear for long terms
+//! \sa Kalsi, Peltola, Tarhio: Comparison of exact string matching algorithms for biological sequences
+//! \note reads only within text, no alignment or padding needed
+struct LongKernel {
+    static constexpr size_t HASH = 4096;
+
+    std::string term;
+    uint16_t shift[HASH]; // shift by the last pair of a window
+    uint16_t next = 1;    // shift after a verified window
+    size_t one = 0;       // offsets of the anchor bytes in term
+    size_t two = 0;
+    __m128i first;
+    __m128i second;
+
+    static inline size_t hash( const unsigned char a, const unsigned char b ) {
+        return ( ( a << 5 ) ^ b ) & ( HASH - 1 );
+    }
+
+    explicit LongKernel( const std::string& text ) : term( text ) {
+        const size_t size = term.size();
+        const uint16_t longest = static_cast<uint16_t>( std::min<size_t>( size - 1, UINT16_MAX ) );
+        const unsigned char* data = reinterpret_cast<const unsigned char*>( term.data() );
+
+        std::fill( shift, shift + HASH, longest );
+
+        // pairs later in term shift less, the last pair doesn't shift at all
+        for( size_t i = 1; i < size; ++i ) {
+            shift[hash( data[i - 1], data[i] )] = static_cast<uint16_t>( std::min<size_t>( size - 1 - i, longest ) );
+        }
+
+        // an earlier occurrence of the last pair, or the full term length
+        const size_t last = hash( data[size - 2], data[size - 1] );
+        next = longest;
+
+        for( size_t i = 1; i + 1 < size; ++i ) {
+            if( hash( data[i - 1], data[i] ) == last ) { next = static_cast<uint16_t>( std::min<size_t>( size - 1 - i, longest ) ); }
+        }
+
+        std::tie( one, two ) = rarest( term.data(), size );
+        first  = _mm_set1_epi8( term[one] );
+        second = _mm_set1_epi8( term[two] );
+    }
+
+    //! \returns compare mask of term starts in the 16 bytes at ptr, where both anchor bytes match
+    inline __m128i candidates( const char* ptr ) const {
+        const __m128i a = _mm_loadu_si128( ( __m128i const* )( ptr + one ) );
+        const __m128i b = _mm_loadu_si128( ( __m128i const* )( ptr + two ) );
+        return _mm_and_si128( _mm_cmpeq_epi8( a, first ), _mm_cmpeq_epi8( b, second ) );
+    }
+
+    static inline uint64_t bits( const __m128i mask ) {
+        return static_cast<unsigned>( _mm_movemask_epi8( mask ) );
+    }
+
+    //! \returns true, if term starts at ptr
+    inline bool verify( const char* ptr ) const {
+        const char* needle = term.data();
+        const size_t size = term.size();
+        size_t pos = 0;
+
+        for( ; pos + SSE128 <= size; pos += SSE128 ) {
+            const __m128i a = _mm_loadu_si128( ( __m128i const* )( ptr + pos ) );
+            const __m128i b = _mm_loadu_si128( ( __m128i const* )( needle + pos ) );
+
+            if( _mm_movemask_epi8( _mm_cmpeq_epi8( a, b ) ) != 0xFFFF ) { return false; }
+        }
+
+        // the last, overlapping 16 bytes
+        if( pos < size ) {
+            const __m128i a = _mm_loadu_si128( ( __m128i const* )( ptr + size - SSE128 ) );
+            const __m128i b = _mm_loadu_si128( ( __m128i const* )( needle + size - SSE128 ) );
+            return _mm_movemask_epi8( _mm_cmpeq_epi8( a, b ) ) == 0xFFFF;
+        }
+
+        return true;
+    }
+
+    //! calls onMatch( from, to ) for each, also overlapping, occurrence of term in text, until it returns false
+    template<typename OnMatch>
+    void find( const std::string_view& text, OnMatch onMatch ) const {
+        const char* data = text.data();
+        const size_t size = term.size();
+
+        if( text.size() < size ) { return; }
+
+        const size_t end = text.size() - size;
+        size_t pos = 0;
+
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>( data );
+        constexpr size_t BLOCK = 4 * SSE128;
+
+        //! \returns Horspool shift of the window at pos
+        auto skip = [this, bytes, size]( const size_t pos ) -> size_t {
+            return shift[hash( bytes[pos + size - 2], bytes[pos + size - 1] )];
+        };
+
+        // only terms longer than the filter of 64 bytes skip further
+        const bool skips = size > BLOCK;
+
+        // all loads end before the last window
+        while( pos + BLOCK <= end ) {
+            if( skips ) {
+                const size_t step = skip( pos );
+
+                if( step >= BLOCK ) {
+                    pos += step;
+                    continue;
+                }
+            }
+
+            const char* ptr = data + pos;
+            const __m128i c0 = candidates( ptr );
+            const __m128i c1 = candidates( ptr + SSE128 );
+            const __m128i c2 = candidates( ptr + 2 * SSE128 );
+            const __m128i c3 = candidates( ptr + 3 * SSE128 );
+            const size_t block = pos;
+            pos += BLOCK;
+
+            if( !_mm_movemask_epi8( _mm_or_si128( _mm_or_si128( c0, c1 ), _mm_or_si128( c2, c3 ) ) ) ) { continue; }
+
+            uint64_t mask = bits( c0 ) | bits( c1 ) << SSE128 | bits( c2 ) << 2 * SSE128 | bits( c3 ) << 3 * SSE128;
+
+            while( mask ) {
+                const size_t from = block + std::countr_zero( mask );
+                mask &= mask - 1;
+
+                if( verify( data + from ) && !onMatch( from, from + size ) ) { return; }
+            }
+        }
+
+        // Horspool through the rest
+        while( pos <= end ) {
+            const size_t step = skip( pos );
+
+            if( step ) {
+                pos += step;
+                continue;
+            }
+
+            if( verify( data + pos ) && !onMatch( pos, pos + size ) ) { return; }
+
+            pos += next;
+        }
+    }
+};
+
+inline search::Matches find( const std::string_view& text, const std::string& term ) {
+    search::Matches matches;
+
+    find( text, term, [&matches]( size_t from, size_t to ) {
+        matches.emplace_back( from, to );
+        return true;
+    } );
 
     return matches;
 }
+
+//! \returns number of c in text, compare masks are summed bytewise and added up with psadbw
+inline size_t count( const std::string_view& text, const char c ) {
+    const __m128i needle = _mm_set1_epi8( c );
+    const __m128i zero = _mm_setzero_si128();
+    const char* data = text.data();
+    const size_t size = text.size();
+    size_t found = 0;
+    size_t pos = 0;
+
+    while( pos + SSE128 <= size ) {
+        // each byte of sums counts up to 255 hits
+        const size_t steps = std::min<size_t>( ( size - pos ) / SSE128, 255 );
+        __m128i sums = zero;
+
+        for( size_t step = 0; step < steps; ++step, pos += SSE128 ) {
+            const __m128i text16 = _mm_loadu_si128( ( __m128i const* )( data + pos ) );
+            sums = _mm_sub_epi8( sums, _mm_cmpeq_epi8( text16, needle ) );
+        }
+
+        const __m128i total = _mm_sad_epu8( sums, zero );
+        found += _mm_cvtsi128_si32( total ) + _mm_extract_epi16( total, 4 );
+    }
+
+    for( ; pos < size; ++pos ) {
+        if( data[pos] == c ) { ++found; }
+    }
+
+    return found;
+}
+
 }
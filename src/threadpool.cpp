@@ -15,7 +15,10 @@ void ThreadPool::workOff() {
     Job* job = nullptr;
 
     if( jobs.pop( job ) && job && *job ) {
-        ( *job )();
+        const std::atomic_bool* token = cancelled;
+
+        if( !token || !*token ) { ( *job )(); }
+
         // decrement _after_ job is done
         count--;
         delete job;
@@ -29,6 +32,10 @@ bool ThreadPool::add( const Job& job ) {
     return true;
 }
 
+void ThreadPool::cancelOn( const std::atomic_bool& token ) {
+    cancelled = &token;
+}
+
 void ThreadPool::join() {
     if( running ) {
         running = false;
@@ -39,16 +46,26 @@ void ThreadPool::join() {
     }
 }
 
+void ThreadPool::wait() {
+    while( count ) {
+        std::this_thread::sleep_for( std::chrono::microseconds( 1 ) );
+    }
+}
+
 void ThreadPool::initialize() {
     while( threads-- ) {
         workers.reserve( threads );
         workers.emplace_back( [this] {
+            size_t idle = 0;
+
             for( ;; ) {
 
                 if( count ) {
                     this->workOff();
+                    idle = 0;
                 } else {
-                    std::this_thread::sleep_for( std::chrono::microseconds( 1 ) );
+                    // back off, if the pool idles between jobs of the daemon
+                    std::this_thread::sleep_for( std::chrono::microseconds( ++idle < 10000 ? 1 : 1000 ) );
                 }
 
                 if( !( running || count ) ) {
@@ -20,8 +20,10 @@
 
 #if THREADPOOL == NO_THREADPOOL
 #define POOL struct { \
+    const std::atomic_bool* cancelled = nullptr; \
+    void cancelOn( const std::atomic_bool& token ) { cancelled = &token; } \
     void add( const std::function<void()>& f ) { \
-        f(); \
+        if( !cancelled || !*cancelled ) { f(); } \
     } \
     } pool;
 #endif // NO_THREADPOOL
@@ -29,8 +31,10 @@
 #if THREADPOOL == BOOST_THREADPOOL
 #define POOL struct ThreadPool { \
     boost::asio::thread_pool mPool{ std::min<size_t>( std::thread::hardware_concurrency(), 8u ) }; \
+    const std::atomic_bool* cancelled = nullptr; \
+    void cancelOn( const std::atomic_bool& token ) { cancelled = &token; } \
     void add( const std::function<void()>& f ) { \
-        boost::asio::post( mPool, f ); \
+        boost::asio::post( mPool, [this, f] { if( !cancelled || !*cancelled ) { f(); } } ); \
     } \
     ThreadPool() {} \
     ~ThreadPool() { mPool.join(); } \
@@ -40,8 +44,10 @@
 #if THREADPOOL == ASYNC_THREADPOOL
 #define POOL struct ThreadPool { \
     std::vector<std::future<void>> results; \
+    const std::atomic_bool* cancelled = nullptr; \
+    void cancelOn( const std::atomic_bool& token ) { cancelled = &token; } \
     void add( const std::function<void()>& f ) { \
-        results.emplace_back( std::async( std::launch::async, f ) ); \
+        results.emplace_back( std::async( std::launch::async, [this, f] { if( !cancelled || !*cancelled ) { f(); } } ) ); \
     } \
     ThreadPool() { results.reserve( 1024 ); } \
 } pool;
@@ -61,6 +67,10 @@ class ThreadPool {
         ~ThreadPool();
         bool add( const Job& job );
         void join();
+        //! waits until all jobs are done, the pool keeps running for further jobs
+        void wait();
+        //! once token is set, remaining jobs are drained w/out being executed
+        void cancelOn( const std::atomic_bool& token );
     private:
         void initialize();
         void workOff();
@@ -73,5 +83,6 @@ class ThreadPool {
 
         std::once_flag initialized;
         std::atomic_bool running = {true};
+        std::atomic<const std::atomic_bool*> cancelled = {nullptr}; // rebound per search in warm pools
 };
 
@@ -0,0 +1,596 @@
+#include "trigramindex.hpp"
+
+#include <deque>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "threadpool.hpp"
+#include "searchoptions.hpp"
+#include "utf8.hpp"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+std::string trigram::relativeKey( const sys_string& path, const sys_string& root ) {
+    size_t from = path.compare( 0, root.size(), root ) == 0 ? root.size() : 0;
+
+    while( from < path.size() && ( path[from] == '/' || path[from] == '\\' ) ) { ++from; }
+
+    return fromSysString( path.substr( from ) );
+}
+
+std::string trigram::literal( const SearchOptions& opts ) {
+    // binaries are not indexed and -i with Unicode folding doesn't compare bytes
+    if( opts.binary || opts.isFuzzy || opts.isQuery ) { return std::string(); }
+
+    const std::string literal = opts.isRegex ? requiredLiteral( opts.term ) : opts.term;
+
+    if( literal.size() < 3 || ( opts.ignoreCase && !utf8::isAscii( literal ) ) ) { return std::string(); }
+
+    return literal;
+}
+
+fs::path trigram::location( const fs::path& folder, const std::string& name ) {
+    const fs::path git = folder / ".git";
+    return fs::is_directory( git ) ? git / name : folder / ( "." + name );
+}
+
+const char* trigram::map( const fs::path& file, std::shared_ptr<void>& mapping, size_t& size ) {
+#ifndef _WIN32
+    int fd = open( file.c_str(), O_RDONLY );
+
+    if( fd == -1 ) { return nullptr; }
+
+    utils::ScopeGuard onExit( [fd] { close( fd ); } );
+    size = utils::fileSize( fd );
+
+    if( !size ) { return nullptr; }
+
+    void* ptr = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+    if( ptr == MAP_FAILED ) { return nullptr; }
+
+    const size_t length = size;
+    mapping = std::shared_ptr<void>( ptr, [length]( void* ptr ) { munmap( ptr, length ); } );
+    return static_cast<const char*>( ptr );
+#else
+    // w/out mmap, the file is read into memory
+    std::ifstream in( file.native(), std::ios::binary );
+    std::shared_ptr<std::string> content = std::make_shared<std::string>( ( std::istreambuf_iterator<char>( in ) ), std::istreambuf_iterator<char>() );
+    size = content->size();
+    mapping = content;
+    return size ? content->data() : nullptr;
+#endif
+}
+
+fs::path trigram::segment( const fs::path& base, const size_t n ) {
+    if( !n ) { return base; }
+
+    return base.native() + toSysString( "." + std::to_string( n ) );
+}
+
+std::vector<trigram::Index> trigram::segments( const fs::path& base ) {
+    std::vector<Index> found;
+
+    for( size_t n = 0; ; ++n ) {
+        Index index;
+
+        if( !index.load( segment( base, n ) ) ) { break; }
+
+        found.emplace_back( std::move( index ) );
+    }
+
+    return found;
+}
+
+bool trigram::stamp( const sys_string& path, Stamp& stamp, uint64_t* device ) {
+#ifndef _WIN32
+    struct stat info;
+
+    if( stat( path.c_str(), &info ) != 0 ) { return false; }
+
+    stamp.size = info.st_size;
+    stamp.inode = info.st_ino;
+
+    if( device ) { *device = info.st_dev; }
+
+#ifdef __APPLE__
+    stamp.mtime = info.st_mtimespec.tv_sec * 1000000000ll + info.st_mtimespec.tv_nsec;
+#else
+    stamp.mtime = info.st_mtim.tv_sec * 1000000000ll + info.st_mtim.tv_nsec;
+#endif
+#else
+    boost::system::error_code error;
+    stamp.size = fs::file_size( path, error );
+
+    if( error ) { return false; }
+
+    if( device ) { *device = 0; }
+
+    stamp.mtime = fs::last_write_time( path, error ) * 1000000000ll;
+#endif
+    return true;
+}
+
+void trigram::collect( const std::string_view& content, std::vector<uint32_t>& trigrams ) {
+    static thread_local std::vector<uint64_t> seen( ( 1 << 24 ) / 64 );
+    trigrams.clear();
+
+    for( size_t i = 0; i + 2 < content.size(); ++i ) {
+        const uint32_t trigram = trigramAt( content.data() + i );
+        uint64_t& word = seen[trigram >> 6];
+        const uint64_t bit = 1ull << ( trigram & 63 );
+
+        if( !( word & bit ) ) {
+            word |= bit;
+            trigrams.push_back( trigram );
+        }
+    }
+
+    for( const uint32_t trigram : trigrams ) { seen[trigram >> 6] = 0; }
+
+    std::sort( trigrams.begin(), trigrams.end() );
+}
+
+bool trigram::Index::load( const fs::path& file ) {
+    size_t size = 0;
+    const char* data = map( file, mapping, size );
+
+    if( !data || size < sizeof( Header ) ) { return false; }
+
+    header = reinterpret_cast<const Header*>( data );
+
+    if( memcmp( header->magic, MAGIC, sizeof( MAGIC ) ) || header->version != VERSION || header->size != size ) { return false; }
+
+    files = reinterpret_cast<const File*>( data + header->filesOffset );
+    paths = data + header->pathsOffset;
+    table = reinterpret_cast<const Trigram*>( data + header->trigramsOffset );
+    postings = reinterpret_cast<const uint8_t*>( data + header->postingsOffset );
+
+    ids.reserve( header->files );
+
+    for( uint32_t id = 0; id < header->files; ++id ) {
+        ids.emplace( std::string_view( paths + files[id].path ), id );
+    }
+
+    return true;
+}
+
+std::vector<bool> trigram::Index::candidates( const std::vector<uint32_t>& trigrams ) const {
+    // intersect the shortest posting lists first
+    std::vector<const Trigram*> entries;
+
+    for( const uint32_t trigram : trigrams ) {
+        const Trigram* end = table + header->trigrams;
+        const Trigram* found = std::lower_bound( table, end, trigram, []( const Trigram & entry, const uint32_t trigram ) {
+            return entry.trigram < trigram;
+        } );
+
+        // a missing trigram rules out all files
+        if( found == end || found->trigram != trigram ) { return std::vector<bool>( header->files, false ); }
+
+        entries.push_back( found );
+    }
+
+    std::sort( entries.begin(), entries.end(), []( const Trigram * a, const Trigram * b ) { return a->count < b->count; } );
+
+    std::vector<uint32_t> result;
+    std::vector<uint32_t> next;
+
+    for( size_t i = 0; i < entries.size(); ++i ) {
+        const uint8_t* ptr = postings + entries[i]->offset;
+        uint32_t id = 0;
+        next.clear();
+
+        // merge with the previous result
+        std::vector<uint32_t>::const_iterator it = result.cbegin();
+
+        for( uint32_t n = 0; n < entries[i]->count; ++n ) {
+            id += getVarint( ptr );
+
+            if( i == 0 ) {
+                next.push_back( id );
+                continue;
+            }
+
+            while( it != result.cend() && *it < id ) { ++it; }
+
+            if( it == result.cend() ) { break; }
+
+            if( *it == id ) { next.push_back( id ); }
+        }
+
+        result.swap( next );
+
+        if( result.empty() ) { break; }
+    }
+
+    std::vector<bool> bitmap( header->files, false );
+
+    for( const uint32_t id : result ) { bitmap[id] = true; }
+
+    return bitmap;
+}
+
+void trigram::Filter::setup( const SearchOptions& opts ) {
+    const std::string literal = trigram::literal( opts );
+
+    if( literal.empty() || opts.noIndex ) { return; }
+
+    segments = trigram::segments( location( opts.path ) );
+
+    if( segments.empty() ) { return; }
+
+    const std::vector<uint32_t> needed = trigrams( literal );
+
+    for( const Index& index : segments ) { candidates.emplace_back( index.candidates( needed ) ); }
+
+    root = opts.path.native();
+    active = true;
+}
+
+bool trigram::Filter::mayMatch( const sys_string& path ) const {
+    const std::string key = relativeKey( path, root );
+
+    // newest segment first
+    for( size_t n = segments.size(); n--; ) {
+        auto found = segments[n].ids.find( key );
+
+        if( found == segments[n].ids.end() ) { continue; }
+
+        const uint32_t id = found->second;
+        const File& file = segments[n].files[id];
+
+        if( candidates[n][id] || ( file.flags & ( File::Always | File::Deleted ) ) ) { return true; }
+
+        // changed file
+        Stamp current;
+
+        if( !stamp( path, current ) ) { return true; }
+
+        return current != file.stamp;
+    }
+
+    // new file
+    return true;
+}
+
+namespace {
+
+//! indexed file, filled by the pool
+struct Entry {
+    //! unchanged files keep their entry, restamped ones get their trigrams from the old segment
+    enum class State { Changed, Unchanged, Restamp };
+    std::string path;
+    uint32_t flags = 0;
+    trigram::Stamp stamp;
+    trigram::Blob blob = {};
+    std::vector<uint32_t> trigrams;
+    State state = State::Changed;
+    size_t segment = 0; // of previous entry
+    const trigram::File* previous = nullptr;
+};
+
+//! appends the trigrams of file ids in index to targets[id], if set, in ascending order
+void decode( const trigram::Index& index, const std::vector<std::vector<uint32_t>*>& targets ) {
+    for( uint32_t t = 0; t < index.header->trigrams; ++t ) {
+        const trigram::Trigram& entry = index.table[t];
+        const uint8_t* ptr = index.postings + entry.offset;
+        uint32_t id = 0;
+
+        for( uint32_t n = 0; n < entry.count; ++n ) {
+            id += trigram::getVarint( ptr );
+
+            if( targets[id] ) { targets[id]->push_back( entry.trigram ); }
+        }
+    }
+}
+
+//! \returns output of command, run in the current folder
+std::string output( const std::string& command ) {
+#ifdef _WIN32
+    const std::string nullDevice = "NUL";
+#else
+    const std::string nullDevice = "/dev/null";
+#endif
+    std::string out;
+    FILE* pipe = popen( ( command + " 2> " + nullDevice ).c_str(), "r" );
+
+    if( !pipe ) { return out; }
+
+    char buffer[4096];
+    size_t read = 0;
+
+    while( ( read = fread( buffer, 1, sizeof( buffer ), pipe ) ) ) { out.append( buffer, read ); }
+
+    pclose( pipe );
+    return out;
+}
+
+//! \returns blob ids of files in git's index, which are unmodified in the work tree
+std::unordered_map<std::string, trigram::Blob> gitBlobs() {
+    std::unordered_map<std::string, trigram::Blob> blobs;
+
+    // refreshes git's stat cache like git status does, so ls-files -m lists only files with changed content
+    output( "git update-index -q --refresh" );
+
+    // <mode> SP <blob> SP <stage> TAB <path> NUL
+    const std::string staged = output( "git ls-files -sz" );
+
+    for( size_t from = 0, to = 0; ( to = staged.find( '\0', from ) ) != std::string::npos; from = to + 1 ) {
+        const std::string_view line( staged.data() + from, to - from );
+        const size_t tab = line.find( '\t' );
+
+        // skip conflicts
+        if( tab == std::string::npos || tab < 50 || line[tab - 1] != '0' ) { continue; }
+
+        trigram::Blob& blob = blobs[std::string( line.substr( tab + 1 ) )];
+        const std::string_view hex = line.substr( tab - 43, 40 );
+
+        for( size_t i = 0; i < blob.size(); ++i ) {
+            blob[i] = static_cast<uint8_t>( std::stoi( std::string( hex.substr( 2 * i, 2 ) ), nullptr, 16 ) );
+        }
+    }
+
+    // modified and deleted files differ from their blobs
+    const std::string modified = output( "git ls-files -mz" );
+
+    for( size_t from = 0, to = 0; ( to = modified.find( '\0', from ) ) != std::string::npos; from = to + 1 ) {
+        blobs.erase( modified.substr( from, to - from ) );
+    }
+
+    return blobs;
+}
+
+//! writes entries as index to target
+//! \returns size of the index, 0 on errors
+uint64_t write( const fs::path& target, const std::vector<const Entry*>& entries ) {
+    using namespace trigram;
+
+    // count files per trigram, then fill postings trigram by trigram
+    std::vector<uint32_t> counts( 1 << 24, 0 );
+
+    for( const Entry* entry : entries ) {
+        for( const uint32_t trigram : entry->trigrams ) { ++counts[trigram]; }
+    }
+
+    std::vector<Trigram> table;
+    std::vector<uint64_t> starts( 1 << 24, 0 );
+    uint64_t total = 0;
+
+    for( uint32_t trigram = 0; trigram < counts.size(); ++trigram ) {
+        if( !counts[trigram] ) { continue; }
+
+        starts[trigram] = total;
+        table.push_back( {trigram, counts[trigram], 0} );
+        total += counts[trigram];
+    }
+
+    std::vector<uint32_t> ids( total );
+
+    for( uint32_t id = 0; id < entries.size(); ++id ) {
+        for( const uint32_t trigram : entries[id]->trigrams ) { ids[starts[trigram]++] = id; }
+    }
+
+    std::string postings;
+    uint64_t from = 0;
+
+    for( Trigram& entry : table ) {
+        entry.offset = postings.size();
+        uint32_t previous = 0;
+
+        for( uint64_t i = from; i < from + entry.count; ++i ) {
+            putVarint( postings, ids[i] - previous );
+            previous = ids[i];
+        }
+
+        from += entry.count;
+    }
+
+    // file table and paths
+    std::vector<File> files;
+    std::string paths;
+
+    for( const Entry* entry : entries ) {
+        File& file = files.emplace_back();
+        file.path = static_cast<uint32_t>( paths.size() );
+        file.flags = entry->flags;
+        file.stamp = entry->stamp;
+        file.blob = entry->blob;
+        paths += entry->path;
+        paths += '\0';
+    }
+
+    paths.resize( ( paths.size() + 7 ) / 8 * 8, '\0' );
+
+    Header header;
+    memcpy( header.magic, MAGIC, sizeof( MAGIC ) );
+    header.files = static_cast<uint32_t>( files.size() );
+    header.trigrams = static_cast<uint32_t>( table.size() );
+    header.filesOffset = sizeof( Header );
+    header.pathsOffset = header.filesOffset + files.size() * sizeof( File );
+    header.trigramsOffset = header.pathsOffset + paths.size();
+    header.postingsOffset = header.trigramsOffset + table.size() * sizeof( Trigram );
+    header.size = header.postingsOffset + postings.size();
+
+    // write to a temporary file and rename, so searches never see half an index
+    const fs::path temporary = target.native() + toSysString( ".tmp" );
+    std::ofstream out( temporary.native(), std::ios::binary );
+    out.write( reinterpret_cast<const char*>( &header ), sizeof( Header ) );
+    out.write( reinterpret_cast<const char*>( files.data() ), files.size() * sizeof( File ) );
+    out.write( paths.data(), paths.size() );
+    out.write( reinterpret_cast<const char*>( table.data() ), table.size() * sizeof( Trigram ) );
+    out.write( postings.data(), postings.size() );
+    out.close();
+
+    if( !out ) {
+        LOG( "Error  : could not write " << temporary.string() );
+        return 0;
+    }
+
+    boost::system::error_code error;
+    fs::rename( temporary, target, error );
+
+    if( error ) {
+        LOG( "Error  : could not write " << target.string() );
+        return 0;
+    }
+
+    return header.size;
+}
+
+}
+
+bool trigram::build( const SearchOptions& opts ) {
+    const fs::path base = location( opts.path );
+    const std::vector<Index> segments = trigram::segments( base );
+
+    // newest entry per path
+    std::unordered_map<std::string_view, std::pair<size_t, const File*>> previous;
+
+    for( size_t n = 0; n < segments.size(); ++n ) {
+        for( uint32_t id = 0; id < segments[n].header->files; ++id ) {
+            const File& file = segments[n].files[id];
+            previous[std::string_view( segments[n].paths + file.path )] = {n, &file};
+        }
+    }
+
+    std::unordered_map<std::string_view, bool> seen;
+    std::deque<Entry> entries;
+    const sys_string root = opts.path.native();
+    const bool git = !opts.noGit && fs::exists( opts.path / ".git" );
+
+    // gitBlobs runs in the folder, its blob ids are valid for unmodified files
+    if( git ) { fs::current_path( opts.path ); }
+
+    const std::unordered_map<std::string, Blob> blobs = git ? gitBlobs() : std::unordered_map<std::string, Blob>();
+
+    {
+        POOL;
+        auto onFile = [&]( const sys_string & filename ) {
+            // skip the index and its segments
+            if( filename.compare( 0, base.native().size(), base.native() ) == 0 ) { return; }
+
+            Entry& entry = entries.emplace_back();
+            entry.path = relativeKey( filename, root );
+
+            auto found = previous.find( entry.path );
+
+            if( found != previous.end() && !( found->second.second->flags & File::Deleted ) ) {
+                entry.segment = found->second.first;
+                entry.previous = found->second.second;
+                seen[found->first] = true;
+            }
+
+            auto blob = blobs.find( entry.path );
+
+            if( blob != blobs.end() ) { entry.blob = blob->second; }
+
+            pool.add( [&entry, filename] {
+                if( !stamp( filename, entry.stamp ) ) { return; }
+
+                // same blob or same stamp is the same content
+                if( entry.previous ) {
+                    const bool blobs = entry.blob != Blob() && entry.previous->blob != Blob();
+
+                    if( blobs ? entry.blob == entry.previous->blob : entry.stamp == entry.previous->stamp ) {
+                        entry.state = entry.stamp == entry.previous->stamp ? Entry::State::Unchanged : Entry::State::Restamp;
+                        entry.flags = entry.previous->flags;
+                        return;
+                    }
+                }
+
+                utils::FileView view = utils::fromFileP( filename );
+
+                // UTF-16 files are searched in UTF-8, so they are always searched
+                if( view.encoding != utils::Encoding::Utf8 ) {
+                    entry.flags = File::Always;
+                    return;
+                }
+
+                collect( view.content, entry.trigrams );
+                entry.trigrams.shrink_to_fit();
+            } );
+        };
+
+        if( git ) {
+            utils::gitLsFiles( opts.path, onFile );
+        } else {
+            utils::recurseDir( opts.path.native(), onFile );
+        }
+    }
+
+    // deleted files
+    for( const auto& [path, file] : previous ) {
+        if( seen.count( path ) || ( file.second->flags & File::Deleted ) ) { continue; }
+
+        Entry& entry = entries.emplace_back();
+        entry.path = path;
+        entry.flags = File::Deleted;
+    }
+
+    std::vector<const Entry*> changes;
+
+    for( const Entry& entry : entries ) {
+        if( entry.state != Entry::State::Unchanged ) { changes.push_back( &entry ); }
+    }
+
+    size_t updates = changes.size();
+
+    for( size_t n = 1; n < segments.size(); ++n ) { updates += segments[n].header->files; }
+
+    // compact, if there are too many segments or they shadow half the base
+    const bool compact = segments.empty() || segments.size() >= MAX_SEGMENTS || 2 * updates > segments.front().header->files;
+
+    if( !compact && changes.empty() ) {
+        if( !opts.quiet ) { LOG( "Index " << base.string() << " is up to date" ); }
+
+        return true;
+    }
+
+    // restamped, and with compaction also unchanged files get their trigrams from their segments
+    std::vector<std::vector<std::vector<uint32_t>*>> targets( segments.size() );
+
+    for( size_t n = 0; n < segments.size(); ++n ) { targets[n].resize( segments[n].header->files, nullptr ); }
+
+    for( Entry& entry : entries ) {
+        if( entry.state == Entry::State::Restamp || ( compact && entry.state == Entry::State::Unchanged ) ) {
+            targets[entry.segment][entry.previous - segments[entry.segment].files] = &entry.trigrams;
+        }
+    }
+
+    for( size_t n = 0; n < segments.size(); ++n ) { decode( segments[n], targets[n] ); }
+
+    std::vector<const Entry*> written;
+
+    for( const Entry& entry : entries ) {
+        if( compact ? !( entry.flags & File::Deleted ) : entry.state != Entry::State::Unchanged ) { written.push_back( &entry ); }
+    }
+
+    const fs::path target = compact ? base : segment( base, segments.size() );
+    const uint64_t size = write( target, written );
+
+    if( !size ) { return false; }
+
+    // searches, which still load old segments, compare the stamps of the compacted base with them
+    if( compact ) {
+        boost::system::error_code error;
+
+        for( size_t n = 1; fs::exists( segment( base, n ) ); ++n ) { fs::remove( segment( base, n ), error ); }
+    }
+
+    if( !opts.quiet ) {
+        if( segments.empty() ) {
+            LOG( "Indexed " << written.size() << " files in " << target.string() << " (" << size / 1024 << " kB)" );
+        } else if( compact ) {
+            LOG( "Updated " << changes.size() << " of " << entries.size() << " files and compacted " << segments.size() << " segments in " << target.string() << " (" << size / 1024 << " kB)" );
+        } else {
+            LOG( "Updated " << changes.size() << " of " << entries.size() << " files in " << target.string() << " (" << size / 1024 << " kB)" );
+        }
+    }
+
+    return true;
+}
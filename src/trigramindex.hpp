@@ -0,0 +1,285 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <string_view>
+#include <algorithm>
+#include <cstring>
+#include <array>
+
+#include "utils.hpp"
+
+struct SearchOptions;
+
+//! persistent trigram index like Google's codesearch, which rules out files w/out the trigrams of a term
+//! the file is mmapped as is: header, file table, paths, sorted trigram table, postings
+//! postings are ascending file ids, delta and varint encoded
+//! updates append segments with changed and deleted files, which shadow older segments' entries
+namespace trigram {
+
+constexpr char MAGIC[8] = "FSRCTRI";
+constexpr uint32_t VERSION = 2;
+constexpr size_t MAX_SEGMENTS = 8; // base and its update segments, before they are compacted
+
+//! git blob id, zero if unknown
+using Blob = std::array<uint8_t, 20>;
+
+struct Header {
+    char magic[8] = {};
+    uint32_t version = VERSION;
+    uint32_t files = 0;         // entries in file table
+    uint32_t trigrams = 0;      // entries in trigram table
+    uint32_t reserved = 0;
+    uint64_t filesOffset = 0;   // File[files]
+    uint64_t pathsOffset = 0;   // \0 terminated paths relative to the indexed folder
+    uint64_t trigramsOffset = 0;// Trigram[trigrams], sorted by trigram
+    uint64_t postingsOffset = 0;
+    uint64_t size = 0;          // of the whole index
+};
+
+//! size, mtime in ns and inode of a file
+struct Stamp {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t inode = 0;
+    bool operator==( const Stamp& that ) const { return size == that.size && mtime == that.mtime && inode == that.inode; }
+    bool operator!=( const Stamp& that ) const { return !( *this == that ); }
+};
+
+struct File {
+    enum Flags : uint32_t {
+        Always = 1,             // e.g. UTF-16 files, which are indexed w/out trigrams
+        Deleted = 2             // removes the file of older segments
+    };
+    uint32_t path = 0;          // offset into paths
+    uint32_t flags = 0;
+    Stamp stamp;
+    Blob blob = {};
+    uint32_t reserved = 0;
+};
+
+struct Trigram {
+    uint32_t trigram = 0;       // 3 bytes, ASCII is lower case
+    uint32_t count = 0;         // number of files
+    uint64_t offset = 0;        // into postings
+};
+
+//! appends value as LEB128 varint
+inline void putVarint( std::string& out, uint32_t value ) {
+    while( value >= 0x80 ) {
+        out += static_cast<char>( ( value & 0x7f ) | 0x80 );
+        value >>= 7;
+    }
+
+    out += static_cast<char>( value );
+}
+
+//! \returns LEB128 varint at ptr and moves ptr behind it
+inline uint32_t getVarint( const uint8_t*& ptr ) {
+    uint32_t value = 0;
+
+    for( int shift = 0; ; shift += 7 ) {
+        const uint8_t byte = *ptr++;
+        value |= static_cast<uint32_t>( byte & 0x7f ) << shift;
+
+        if( !( byte & 0x80 ) ) { return value; }
+    }
+}
+
+inline char fold( const char c ) {
+    return c >= 'A' && c <= 'Z' ? c + ( 'a' - 'A' ) : c;
+}
+
+inline uint32_t trigramAt( const char* ptr ) {
+    return static_cast<uint32_t>( static_cast<uint8_t>( fold( ptr[0] ) ) ) << 16 |
+           static_cast<uint32_t>( static_cast<uint8_t>( fold( ptr[1] ) ) ) << 8 |
+           static_cast<uint32_t>( static_cast<uint8_t>( fold( ptr[2] ) ) );
+}
+
+//! \returns sorted, unique trigrams of text
+inline std::vector<uint32_t> trigrams( const std::string_view& text ) {
+    std::vector<uint32_t> found;
+
+    for( size_t i = 0; i + 2 < text.size(); ++i ) { found.push_back( trigramAt( text.data() + i ) ); }
+
+    std::sort( found.begin(), found.end() );
+    found.erase( std::unique( found.begin(), found.end() ), found.end() );
+    return found;
+}
+
+//! collects sorted, unique trigrams of content like trigrams(), but with a bitmap per thread
+void collect( const std::string_view& content, std::vector<uint32_t>& trigrams );
+
+//! \returns longest literal, which every match of regex contains, or an empty string
+//! \note conservative: alternations give up, groups, classes and quantified chars end literals
+inline std::string requiredLiteral( const std::string& regex ) {
+    std::string longest;
+    std::string current;
+    int depth = 0;
+
+    // inline flags like (?i) may fold non ASCII chars, which the index doesn't fold
+    const bool asciiOnly = regex.find( "(?" ) != std::string::npos;
+
+    // other flags like (?x) or (?s:...) change what the chars after them match
+    for( size_t pos = regex.find( "(?" ); pos != std::string::npos; pos = regex.find( "(?", pos + 2 ) ) {
+        size_t flags = pos + 2;
+
+        while( flags < regex.size() && ( isalpha( static_cast<unsigned char>( regex[flags] ) ) || regex[flags] == '-' ) ) { ++flags; }
+
+        if( flags == pos + 2 || flags == regex.size() ) { continue; }
+
+        if( ( regex[flags] == ')' || regex[flags] == ':' ) && regex.compare( pos, flags + 1 - pos, "(?i)" ) ) { return std::string(); }
+    }
+
+    auto end = [&longest, &current] {
+        if( current.size() > longest.size() ) { longest = current; }
+
+        current.clear();
+    };
+
+    for( size_t i = 0; i < regex.size(); ++i ) {
+        char c = regex[i];
+        bool literal = false;
+
+        switch( c ) {
+            case '|': return std::string();
+
+            case '(': ++depth; end(); continue;
+
+            case ')': --depth; end(); continue;
+
+            case '[': {
+                // skip class, ']' right after '[' or '[^' is part of it
+                size_t j = i + 1;
+
+                if( j < regex.size() && regex[j] == '^' ) { ++j; }
+
+                if( j < regex.size() && regex[j] == ']' ) { ++j; }
+
+                while( j < regex.size() && regex[j] != ']' ) {
+                    // POSIX classes like [:alpha:], [=a=] and [.-.] end with their own ']'
+                    if( regex[j] == '[' && j + 1 < regex.size() && strchr( ":=.", regex[j + 1] ) ) {
+                        const size_t close = regex.find( std::string{ regex[j + 1], ']' }, j + 2 );
+
+                        if( close != std::string::npos ) {
+                            j = close + 2;
+                            continue;
+                        }
+                    }
+
+                    j += regex[j] == '\\' ? 2 : 1;
+                }
+
+                i = j;
+                end();
+                continue;
+            }
+
+            case '\\':
+                if( i + 1 == regex.size() ) { return std::string(); }
+
+                c = regex[++i];
+
+                // escaped punctuation is literal, single char escapes like \w or \b end literals
+                if( ispunct( static_cast<unsigned char>( c ) ) ) {
+                    literal = true;
+                } else if( !strchr( "bBsSwWdDntrfvAzZ", c ) ) {
+                    return std::string(); // \x41, \p{L}, \1, \Q...
+                }
+
+                break;
+
+            // digits of quantifiers like {2,3} are no literal
+            case '{':
+                while( i + 1 < regex.size() && regex[i] != '}' ) { ++i; }
+
+                end();
+                continue;
+
+            case '.': case '^': case '$': case '*': case '+': case '?': case '}':
+                break;
+
+            default:
+                literal = true;
+        }
+
+        if( !literal || depth || ( asciiOnly && static_cast<unsigned char>( c ) >= 0x80 ) ) {
+            end();
+            continue;
+        }
+
+        // optional chars end the literal w/out them, required ones after them
+        const char next = i + 1 < regex.size() ? regex[i + 1] : '\0';
+
+        if( next == '?' || next == '*' || next == '{' ) {
+            end();
+        } else {
+            current += c;
+
+            if( next == '+' ) { end(); }
+        }
+    }
+
+    end();
+    return longest;
+}
+
+//! mmapped index or update segment
+struct Index {
+    std::shared_ptr<void> mapping;
+    const Header* header = nullptr;
+    const File* files = nullptr;
+    const char* paths = nullptr;
+    const Trigram* table = nullptr;
+    const uint8_t* postings = nullptr;
+    std::unordered_map<std::string_view, uint32_t> ids; // of relative paths
+
+    //! \returns false, if file is missing or invalid
+    bool load( const fs::path& file );
+    //! \returns bitmap of file ids, which contain all trigrams
+    std::vector<bool> candidates( const std::vector<uint32_t>& trigrams ) const;
+};
+
+//! skips files in SearchController::search, which can't match
+struct Filter {
+    std::vector<Index> segments;
+    std::vector<std::vector<bool>> candidates; // per segment
+    sys_string root;    // prefix of absolute paths
+    bool active = false;
+
+    //! loads the index, if the search has a literal of at least 3 bytes
+    void setup( const SearchOptions& opts );
+    //! \returns false, if path is unchanged since indexing and w/out the term's trigrams
+    bool mayMatch( const sys_string& path ) const;
+};
+
+//! \returns location of the index or other cache name for folder, in .git, if it exists, else hidden in folder
+fs::path location( const fs::path& folder, const std::string& name = "fsrc.idx" );
+
+//! mmaps file or reads it on Windows, mapping owns it
+//! \returns content, nullptr if file is missing or empty
+const char* map( const fs::path& file, std::shared_ptr<void>& mapping, size_t& size );
+
+//! \returns path relative to root as key in the index, git ls-files already gives relative paths
+std::string relativeKey( const sys_string& path, const sys_string& root );
+
+//! \returns literal of at least 3 bytes, which every match of opts' search contains, or an empty string
+std::string literal( const SearchOptions& opts );
+
+//! \returns path of the nth update segment of base, 0 is base itself
+fs::path segment( const fs::path& base, const size_t n );
+
+//! \returns base and its update segments, which are valid
+std::vector<Index> segments( const fs::path& base );
+
+//! sets device, if given
+//! \returns false, if path doesn't exist
+bool stamp( const sys_string& path, Stamp& stamp, uint64_t* device = nullptr );
+
+//! indexes all files, which a search in opts.path would search
+//! with an existing index, only new, changed and deleted files are written to an update segment
+bool build( const SearchOptions& opts );
+
+}
@@ -1,9 +1,49 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace search {
 using Iter = std::string_view::const_iterator;
-using Match = std::pair<Iter, Iter>;
+using Offset = uint32_t;
+
+//! match [from, to) as offsets into the searched content, half the size of two iterators
+//! \note files are read in one piece, the readers in utils skip files over 4 GB
+struct Match {
+    Offset from = 0;
+    Offset to = 0;
+
+    Match() = default;
+    Match( const size_t from, const size_t to ) : from( static_cast<Offset>( from ) ), to( static_cast<Offset>( to ) ) {}
+
+    inline Iter begin( const std::string_view& content ) const { return content.cbegin() + from; }
+    inline Iter end( const std::string_view& content ) const { return content.cbegin() + to; }
+};
+
+//! line of matches with its 1-based number, [begin, end) excludes the newline
+//! \note lines of matches across newlines span from the first to the last line of the match
+struct Line {
+    Offset number = 0;
+    Offset begin = 0;
+    Offset end = 0;
+
+    inline std::string_view view( const std::string_view& content ) const { return content.substr( begin, end - begin ); }
+};
+
+//! filled by searchers, owned and reused by the caller
+using Matches = std::vector<Match>;
+using Lines = std::vector<Line>;
+
+//! matches of one file for embedders, see session::Session
+//! \note lines and matches are offsets into text, which holds the lines of the matches, each followed by \n
+struct Result {
+    std::string path;   // UTF-8, absolute in git repos like clickable paths, else as found by the walker
+    size_t count = 0;   // matches in the file, 1 with --files
+    std::string text;   // empty with --count and --files
+    Lines lines;
+    Matches matches;
+};
 }
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utf8.hpp"
+#include "ssefind.hpp"
+
+//! search in UTF-16 files w/out transcoding them completely
+namespace utf16 {
+
+//! \returns UTF-8 text encoded as UTF-16 bytes
+inline std::string fromUtf8( const std::string& text, const bool bigEndian ) {
+    std::string out;
+    const unsigned char* data = reinterpret_cast<const unsigned char*>( text.data() );
+    size_t pos = 0;
+
+    auto add = [&out, bigEndian]( const char32_t unit ) {
+        const char high = static_cast<char>( unit >> 8 );
+        const char low = static_cast<char>( unit & 0xFF );
+        out += bigEndian ? high : low;
+        out += bigEndian ? low : high;
+    };
+
+    while( pos < text.size() ) {
+        char32_t c = 0;
+        size_t length = 1;
+
+        // invalid bytes can't be found in UTF-16
+        if( !utf8::decode( data + pos, text.size() - pos, c, length ) ) {
+            c = 0xFFFD;
+            length = 1;
+        }
+
+        if( c >= 0x10000 ) {
+            add( 0xD800 + ( ( c - 0x10000 ) >> 10 ) );
+            add( 0xDC00 + ( ( c - 0x10000 ) & 0x3FF ) );
+        } else {
+            add( c );
+        }
+
+        pos += length;
+    }
+
+    return out;
+}
+
+namespace {
+
+inline char32_t unitAt( const unsigned char* data, const bool bigEndian ) {
+    return bigEndian ? ( data[0] << 8 ) | data[1] : ( data[1] << 8 ) | data[0];
+}
+
+//! appends UTF-16 units [from, to) to out as UTF-8, lone surrogates become U+FFFD
+inline void appendUtf8( const unsigned char* data, size_t from, const size_t to, const bool bigEndian, std::string& out ) {
+    while( from + 1 < to ) {
+        char32_t c = unitAt( data + from, bigEndian );
+        from += 2;
+
+        if( c >= 0xD800 && c <= 0xDBFF && from + 1 < to ) {
+            const char32_t low = unitAt( data + from, bigEndian );
+
+            if( low >= 0xDC00 && low <= 0xDFFF ) {
+                c = 0x10000 + ( ( c - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+                from += 2;
+            }
+        }
+
+        if( c >= 0xD800 && c <= 0xDFFF ) { c = 0xFFFD; }
+
+        utf8::encode( c, out );
+    }
+}
+
+//! \returns offset of the next '\n' unit at or after from, or to
+inline size_t nextNewline( const unsigned char* data, size_t from, const size_t to, const bool bigEndian ) {
+    const size_t low = bigEndian ? 1 : 0;
+
+    while( from + 1 < to ) {
+        const void* found = memchr( data + from + low, '\n', to - from - low );
+
+        if( !found ) { return to; }
+
+        const size_t pos = static_cast<const unsigned char*>( found ) - data - low;
+
+        // '\n' must be the low byte of an aligned unit with a zero high byte
+        if( ( pos - from ) % 2 == 0 && pos + 1 < to && !data[pos + 1 - low] ) { return pos; }
+
+        from = pos + ( ( pos - from ) % 2 ? 1 : 2 );
+    }
+
+    return to;
+}
+
+}
+
+//! transcodes UTF-16 content to UTF-8
+//! \param term UTF-16 encoded literal term, if not empty, only lines with term are transcoded
+//!             and other lines stay empty to keep the line numbers
+//! \returns false, if term is not in content
+inline bool toUtf8( const std::string_view& content, const bool bigEndian, const std::string& term, std::string& out ) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>( content.data() );
+    const bool hasBom = content.size() >= 2 && unitAt( data, bigEndian ) == 0xFEFF;
+    const size_t begin = hasBom ? 2 : 0;
+    const size_t end = begin + ( content.size() - begin ) / 2 * 2;
+
+    // find term with the SSE kernel on the raw bytes, but only at unit boundaries
+    std::vector<size_t> candidates;
+
+    if( !term.empty() ) {
+        if( content.size() < term.size() ) { return false; }
+
+        sse::find( content, term, [&candidates, begin, end, &term]( size_t pos, size_t ) {
+            if( pos >= begin && ( pos - begin ) % 2 == 0 && pos + term.size() <= end ) { candidates.push_back( pos ); }
+
+            return true;
+        } );
+
+        if( candidates.empty() ) { return false; }
+    }
+
+    out.clear();
+    auto candidate = candidates.cbegin();
+    size_t from = begin;
+
+    while( from < end ) {
+        const size_t to = nextNewline( data, from, end, bigEndian );
+
+        // skip candidates before this line
+        while( candidate != candidates.cend() && *candidate < from ) { ++candidate; }
+
+        if( term.empty() || ( candidate != candidates.cend() && *candidate < to ) ) {
+            appendUtf8( data, from, to, bigEndian, out );
+        }
+
+        if( to == end ) { break; }
+
+        out += '\n';
+        from = to + 2;
+    }
+
+    return true;
+}
+
+}
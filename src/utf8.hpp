@@ -0,0 +1,454 @@
+#pragma once
+
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <functional>
+#include <emmintrin.h>
+
+#include "winutils.hpp"
+
+//! case insensitive search in UTF-8 with Unicode simple case folding
+//! \sa https://www.unicode.org/Public/UCD/latest/ucd/CaseFolding.txt
+namespace utf8 {
+
+//! all code points, which fold onto another one, are below LAST
+constexpr char32_t LAST = 0x2200;
+
+//! \returns simple case folding of c for Latin, Greek, Cyrillic and Armenian, or c
+//! \note Turkish dotted İ and dotless ı fold to i, German ẞ folds to ß
+inline char32_t fold( const char32_t c ) {
+    if( c < 0x80 ) { return c >= 'A' && c <= 'Z' ? c + 32 : c; }
+
+    // Latin-1
+    if( c >= 0xC0 && c <= 0xDE && c != 0xD7 ) { return c + 32; }
+
+    if( c == 0xB5 ) { return 0x3BC; }
+
+    // Latin Extended-A
+    if( c >= 0x100 && c <= 0x17F ) {
+        if( c == 0x130 || c == 0x131 ) { return 'i'; }
+
+        if( c == 0x178 ) { return 0xFF; }
+
+        if( c == 0x17F ) { return 's'; }
+
+        if( c == 0x138 || c == 0x149 ) { return c; }
+
+        const bool odd = ( c >= 0x139 && c <= 0x148 ) || ( c >= 0x179 && c <= 0x17E );
+        return ( c & 1 ) == ( odd ? 1u : 0u ) ? c + 1 : c;
+    }
+
+    // Latin Extended-B, e.g. African letters, Pinyin and Romanian
+    if( c >= 0x180 && c <= 0x24F ) {
+        // irregular upper case letters, 0 folds to itself
+        static const char16_t irregular[0x40] = {
+            0, 0x253, 0x183, 0, 0x185, 0, 0x254, 0x188,
+            0, 0x256, 0x257, 0x18C, 0, 0, 0x1DD, 0x259,
+            0x25B, 0x192, 0, 0x260, 0x263, 0, 0x269, 0x268,
+            0x199, 0, 0, 0, 0x26F, 0x272, 0, 0x275,
+            0x1A1, 0, 0x1A3, 0, 0x1A5, 0, 0x280, 0x1A8,
+            0, 0x283, 0, 0, 0x1AD, 0, 0x288, 0x1B0,
+            0, 0x28A, 0x28B, 0x1B4, 0, 0x1B6, 0, 0x292,
+            0x1B9, 0, 0, 0, 0x1BD, 0, 0, 0
+        };
+
+        if( c < 0x1C0 ) { return irregular[c - 0x180] ? irregular[c - 0x180] : c; }
+
+        // digraphs like Ǆ, ǅ and ǆ
+        if( c == 0x1C4 || c == 0x1C7 || c == 0x1CA || c == 0x1F1 ) { return c + 2; }
+
+        if( c == 0x1C5 || c == 0x1C8 || c == 0x1CB || c == 0x1F2 ) { return c + 1; }
+
+        if( c >= 0x1CD && c <= 0x1DC ) { return c & 1 ? c + 1 : c; }
+
+        if( ( c >= 0x1DE && c <= 0x1EF ) || ( c >= 0x1F8 && c <= 0x21F ) || ( c >= 0x222 && c <= 0x233 ) || ( c >= 0x246 && c <= 0x24F ) ) { return c & 1 ? c : c + 1; }
+
+        switch( c ) {
+            case 0x1F4: return 0x1F5;
+
+            case 0x1F6: return 0x195;
+
+            case 0x1F7: return 0x1BF;
+
+            case 0x220: return 0x19E;
+
+            case 0x23B: return 0x23C;
+
+            case 0x23D: return 0x19A;
+
+            case 0x241: return 0x242;
+
+            case 0x243: return 0x180;
+
+            case 0x244: return 0x289;
+
+            case 0x245: return 0x28C;
+        }
+
+        // Ⱥ and Ⱦ fold beyond LAST and stay unfolded
+        return c;
+    }
+
+    // Greek
+    if( c >= 0x370 && c <= 0x3FF ) {
+        if( c >= 0x391 && c <= 0x3AB && c != 0x3A2 ) { return c + 32; }
+
+        if( c == 0x386 ) { return 0x3AC; }
+
+        if( c >= 0x388 && c <= 0x38A ) { return c + 37; }
+
+        if( c == 0x38C ) { return 0x3CC; }
+
+        if( c == 0x38E || c == 0x38F ) { return c + 63; }
+
+        if( c == 0x3C2 ) { return 0x3C3; }
+
+        return c;
+    }
+
+    // Cyrillic
+    if( c >= 0x400 && c <= 0x52F ) {
+        if( c <= 0x40F ) { return c + 80; }
+
+        if( c <= 0x42F ) { return c + 32; }
+
+        if( c == 0x4C0 ) { return 0x4CF; }
+
+        if( c >= 0x4C1 && c <= 0x4CE ) { return c & 1 ? c + 1 : c; }
+
+        if( ( c >= 0x460 && c <= 0x481 ) || ( c >= 0x48A && c <= 0x4BF ) || c >= 0x4D0 ) { return c & 1 ? c : c + 1; }
+
+        return c;
+    }
+
+    // Armenian
+    if( c >= 0x531 && c <= 0x556 ) { return c + 48; }
+
+    // Latin Extended Additional, e.g. Vietnamese
+    if( c >= 0x1E00 && c <= 0x1EFF ) {
+        if( c == 0x1E9E ) { return 0xDF; }
+
+        if( c <= 0x1E95 || c >= 0x1EA0 ) { return c & 1 ? c : c + 1; }
+
+        return c;
+    }
+
+    switch( c ) {
+        case 0x2126: return 0x3C9; // Ohm sign
+
+        case 0x212A: return 'k';   // Kelvin sign
+
+        case 0x212B: return 0xE5;  // Angstrom sign
+    }
+
+    return c;
+}
+
+//! decodes one code point at data
+//! \returns false for invalid or overlong sequences
+inline bool decode( const unsigned char* data, const size_t size, char32_t& c, size_t& length ) {
+    if( !size ) { return false; }
+
+    const unsigned char lead = data[0];
+
+    if( lead < 0x80 ) {
+        c = lead;
+        length = 1;
+        return true;
+    }
+
+    if( lead >= 0xC2 && lead <= 0xDF ) {
+        c = lead & 0x1F;
+        length = 2;
+    } else if( lead >= 0xE0 && lead <= 0xEF ) {
+        c = lead & 0x0F;
+        length = 3;
+    } else if( lead >= 0xF0 && lead <= 0xF4 ) {
+        c = lead & 0x07;
+        length = 4;
+    } else {
+        return false;
+    }
+
+    if( length > size ) { return false; }
+
+    for( size_t i = 1; i < length; ++i ) {
+        if( ( data[i] & 0xC0 ) != 0x80 ) { return false; }
+
+        c = ( c << 6 ) | ( data[i] & 0x3F );
+    }
+
+    // overlong three and four byte sequences and surrogates
+    if( ( length == 3 && c < 0x800 ) || ( length == 4 && ( c < 0x10000 || c > 0x10FFFF ) ) || ( c >= 0xD800 && c <= 0xDFFF ) ) { return false; }
+
+    return true;
+}
+
+inline void encode( const char32_t c, std::string& out ) {
+    if( c < 0x80 ) {
+        out += static_cast<char>( c );
+    } else if( c < 0x800 ) {
+        out += static_cast<char>( 0xC0 | ( c >> 6 ) );
+        out += static_cast<char>( 0x80 | ( c & 0x3F ) );
+    } else if( c < 0x10000 ) {
+        out += static_cast<char>( 0xE0 | ( c >> 12 ) );
+        out += static_cast<char>( 0x80 | ( ( c >> 6 ) & 0x3F ) );
+        out += static_cast<char>( 0x80 | ( c & 0x3F ) );
+    } else {
+        out += static_cast<char>( 0xF0 | ( c >> 18 ) );
+        out += static_cast<char>( 0x80 | ( ( c >> 12 ) & 0x3F ) );
+        out += static_cast<char>( 0x80 | ( ( c >> 6 ) & 0x3F ) );
+        out += static_cast<char>( 0x80 | ( c & 0x3F ) );
+    }
+}
+
+//! \returns true, if text contains only ASCII bytes
+inline bool isAscii( const std::string_view& text ) {
+    size_t pos = 0;
+
+    // the high bits of 16 bytes at once
+    for( ; pos + sizeof( __m128i ) <= text.size(); pos += sizeof( __m128i ) ) {
+        if( _mm_movemask_epi8( _mm_loadu_si128( ( __m128i const* )( text.data() + pos ) ) ) ) { return false; }
+    }
+
+    for( ; pos < text.size(); ++pos ) {
+        if( static_cast<unsigned char>( text[pos] ) >= 0x80 ) { return false; }
+    }
+
+    return true;
+}
+
+//! \returns true, if text has a code point, which folds to another one, e.g. for --smart-case
+//! \param escaped if true, chars after a backslash don't count, like \W or \S in regexes
+inline bool hasUpper( const std::string_view& text, const bool escaped ) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>( text.data() );
+    size_t pos = 0;
+
+    while( pos < text.size() ) {
+        char32_t c = 0;
+        size_t length = 1;
+
+        if( !decode( data + pos, text.size() - pos, c, length ) ) {
+            length = 1;
+        } else if( escaped && c == '\\' ) {
+            // skip the escaped code point
+            size_t skipped = 1;
+
+            if( !decode( data + pos + 1, text.size() - pos - 1, c, skipped ) ) { skipped = 1; }
+
+            length += skipped;
+        } else if( fold( c ) != c ) {
+            return true;
+        }
+
+        pos += length;
+    }
+
+    return false;
+}
+
+//! UTF-8 sequences of all code points, which fold like one code point of the term
+//! as valid UTF-8 is prefix and suffix free, at most one of them matches at a position
+struct Position {
+    std::vector<std::string> variants;
+    unsigned char leads[4] = {}; // first bytes of variants, repeated to fill
+    size_t leadCount = 0;
+};
+
+struct Pattern {
+    std::vector<Position> positions;
+    size_t anchor = 0; // rarest position, which is searched first
+};
+
+namespace {
+
+//! \returns rough frequency of c in source code, higher is more frequent, non ASCII bytes are rare
+inline size_t frequency( const unsigned char c ) {
+    static const std::string_view common = "zqjxkvbywgpfmucdlhrsnioate ";
+    const size_t pos = common.find( static_cast<char>( c < 0x80 ? tolower( c ) : c ) );
+    return pos == std::string_view::npos ? 0 : pos + 1;
+}
+
+}
+
+//! precomputes the folded byte sequences of each code point of term
+//! \returns false, if term is empty or a position has more than four first bytes
+inline bool compile( const std::string& term, Pattern& pattern ) {
+    pattern = Pattern();
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>( term.data() );
+    size_t pos = 0;
+
+    while( pos < term.size() ) {
+        Position position;
+        char32_t c = 0;
+        size_t length = 1;
+
+        if( decode( data + pos, term.size() - pos, c, length ) ) {
+            const char32_t folded = fold( c );
+
+            for( char32_t other = 0; other < LAST; ++other ) {
+                if( fold( other ) == folded ) {
+                    position.variants.emplace_back();
+                    encode( other, position.variants.back() );
+                }
+            }
+
+            // e.g. CJK or emojis
+            if( c >= LAST ) {
+                position.variants.emplace_back();
+                encode( c, position.variants.back() );
+            }
+        } else {
+            // invalid bytes match only themselves
+            length = 1;
+            position.variants.emplace_back( 1, term[pos] );
+        }
+
+        pos += length;
+
+        for( const std::string& variant : position.variants ) {
+            const unsigned char lead = variant.front();
+            unsigned char* last = position.leads + position.leadCount;
+
+            if( std::find( position.leads, last, lead ) != last ) { continue; }
+
+            if( position.leadCount == 4 ) { return false; }
+
+            position.leads[position.leadCount++] = lead;
+        }
+
+        for( size_t i = position.leadCount; i < 4; ++i ) { position.leads[i] = position.leads[0]; }
+
+        pattern.positions.emplace_back( std::move( position ) );
+    }
+
+    if( pattern.positions.empty() ) { return false; }
+
+    // anchor at the position with the rarest first bytes
+    size_t rarest = std::numeric_limits<size_t>::max();
+
+    for( size_t i = 0; i < pattern.positions.size(); ++i ) {
+        const Position& position = pattern.positions[i];
+        size_t score = 0;
+
+        for( size_t j = 0; j < position.leadCount; ++j ) { score += frequency( position.leads[j] ) + 1; }
+
+        if( score < rarest ) {
+            rarest = score;
+            pattern.anchor = i;
+        }
+    }
+
+    return true;
+}
+
+//! \returns true, if a non ASCII code point folds like one of pattern, e.g. the Kelvin sign K like k
+inline bool hasNonAscii( const Pattern& pattern ) {
+    for( const Position& position : pattern.positions ) {
+        for( const std::string& variant : position.variants ) {
+            if( static_cast<unsigned char>( variant.front() ) >= 0x80 ) { return true; }
+        }
+    }
+
+    return false;
+}
+
+namespace {
+
+//! \returns first occurrence of one of the four bytes
+inline const unsigned char* find4( const unsigned char* data, const size_t size, const unsigned char* bytes ) {
+    const __m128i a = _mm_set1_epi8( bytes[0] );
+    const __m128i b = _mm_set1_epi8( bytes[1] );
+    const __m128i c = _mm_set1_epi8( bytes[2] );
+    const __m128i d = _mm_set1_epi8( bytes[3] );
+    size_t pos = 0;
+
+    for( ; pos + sizeof( __m128i ) <= size; pos += sizeof( __m128i ) ) {
+        const __m128i text16 = _mm_loadu_si128( ( __m128i const* )( data + pos ) );
+        const __m128i ab = _mm_or_si128( _mm_cmpeq_epi8( text16, a ), _mm_cmpeq_epi8( text16, b ) );
+        const __m128i cd = _mm_or_si128( _mm_cmpeq_epi8( text16, c ), _mm_cmpeq_epi8( text16, d ) );
+        const int mask = _mm_movemask_epi8( _mm_or_si128( ab, cd ) );
+
+        if( mask ) { return data + pos + ffs( mask ) - 1; }
+    }
+
+    for( ; pos < size; ++pos ) {
+        if( memchr( bytes, data[pos], 4 ) ) { return data + pos; }
+    }
+
+    return nullptr;
+}
+
+//! \returns size of the variant of position, which starts at data[pos], or 0
+inline size_t matchForward( const std::string_view& text, const size_t pos, const Position& position ) {
+    for( const std::string& variant : position.variants ) {
+        if( text.size() - pos >= variant.size() && !memcmp( text.data() + pos, variant.data(), variant.size() ) ) { return variant.size(); }
+    }
+
+    return 0;
+}
+
+//! \returns size of the variant of position, which ends at data[pos], or 0
+inline size_t matchBackward( const std::string_view& text, const size_t pos, const Position& position ) {
+    for( const std::string& variant : position.variants ) {
+        if( pos >= variant.size() && !memcmp( text.data() + pos - variant.size(), variant.data(), variant.size() ) ) { return variant.size(); }
+    }
+
+    return 0;
+}
+
+}
+
+//! calls onMatch for all non overlapping matches of pattern in text, until it returns false
+inline void find( const std::string_view& text, const Pattern& pattern, const std::function<bool( size_t from, size_t to )>& onMatch ) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>( text.data() );
+    const size_t size = text.size();
+    const Position& anchor = pattern.positions[pattern.anchor];
+
+    size_t from = 0; // no match may start before from
+    size_t pos = 0;
+
+    while( pos < size ) {
+        const unsigned char* next = find4( data + pos, size - pos, anchor.leads );
+
+        if( !next ) { return; }
+
+        pos = next - data;
+
+        // verify positions after the anchor
+        size_t end = pos;
+        bool found = true;
+
+        for( size_t i = pattern.anchor; found && i < pattern.positions.size(); ++i ) {
+            const size_t length = matchForward( text, end, pattern.positions[i] );
+            found = length;
+            end += length;
+        }
+
+        // and before the anchor
+        size_t begin = pos;
+
+        for( size_t i = pattern.anchor; found && i > 0; --i ) {
+            const size_t length = matchBackward( text, begin, pattern.positions[i - 1] );
+            found = length && begin - length >= from;
+            begin -= length;
+        }
+
+        if( found ) {
+            if( !onMatch( begin, end ) ) { return; }
+
+            from = end;
+            pos = end;
+        } else {
+            ++pos;
+        }
+    }
+}
+
+}
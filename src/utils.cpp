@@ -24,7 +24,9 @@ const std::map<Color, WORD> winColors = {
 #else
 
 #include <dirent.h>
+#include <unistd.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 
 #ifdef __linux__
 #define fwrite fwrite_unlocked
@@ -75,8 +77,13 @@ void utils::printColor( Color color, const std::string& text ) {
     }
 }
 
-// git ls-files -zco --exclude-standard | tr '\0' '\n'
 void utils::gitLsFiles( const fs::path& path, const std::function<void( const sys_string& filename )>& callback ) {
+    const std::atomic_bool never = {false};
+    gitLsFiles( path, callback, never );
+}
+
+// git ls-files -zco --exclude-standard | tr '\0' '\n'
+void utils::gitLsFiles( const fs::path& path, const std::function<void( const sys_string& filename )>& callback, const std::atomic_bool& cancelled ) {
 
     fs::current_path( path );
 
@@ -101,7 +108,7 @@ void utils::gitLsFiles( const fs::path& path, const std::function<void( const sy
 
     if( !pipe ) { return; }
 
-    while( !feof( pipe ) ) {
+    while( !feof( pipe ) && !cancelled ) {
 #ifdef _WIN32
 
         if( fgetws( buffer.data(), 1_kB, pipe ) != nullptr ) {
@@ -158,6 +165,46 @@ bool utils::isTextFile( const std::string_view& content ) {
     return !hasDoubleZero;
 }
 
+utils::Encoding utils::detectEncoding( const std::string_view& content ) {
+    if( content.size() >= 2 ) {
+        // UTF-32 LE starts with FF FE 00 00
+        if( 0 == memcmp( content.data(), "\xFF\xFE", 2 ) && content.substr( 2, 2 ) != std::string_view( "\0\0", 2 ) ) { return Encoding::Utf16LE; }
+
+        if( 0 == memcmp( content.data(), "\xFE\xFF", 2 ) ) { return Encoding::Utf16BE; }
+    }
+
+    // w/out BOM, mostly ASCII text has zeros in every other byte
+    const size_t pairs = content.size() / 2;
+
+    if( pairs < 2 ) { return Encoding::Utf8; }
+
+    auto isText = []( const unsigned char c ) { return c >= 0x20 || c == '\t' || c == '\n' || c == '\r'; };
+    size_t evenZeros = 0;
+    size_t oddZeros = 0;
+    size_t asciiLE = 0;
+    size_t asciiBE = 0;
+
+    for( size_t i = 0; i < pairs; ++i ) {
+        const unsigned char even = content[2 * i];
+        const unsigned char odd = content[2 * i + 1];
+
+        if( !even ) { evenZeros++; }
+
+        if( !odd ) { oddZeros++; }
+
+        if( !odd && isText( even ) ) { asciiLE++; }
+
+        if( !even && isText( odd ) ) { asciiBE++; }
+    }
+
+    // few zeros in the other half, e.g. from U+0100 or emojis
+    if( asciiLE * 4 >= pairs * 3 && evenZeros * 16 <= pairs ) { return Encoding::Utf16LE; }
+
+    if( asciiBE * 4 >= pairs * 3 && oddZeros * 16 <= pairs ) { return Encoding::Utf16BE; }
+
+    return Encoding::Utf8;
+}
+
 // splits content on newline
 utils::Lines utils::parseContent( const char* data, const size_t size, const long long stop ) {
     Lines lines;
@@ -191,8 +238,9 @@ utils::FileView utils::fromFileP( const sys_string& filename ) {
     IF_RET( file == -1 );
     utils::ScopeGuard onExit( [file] { close( file ); } );
 
+    // match offsets are 32 bit
     view.size = utils::fileSize( file );
-    IF_RET( !view.size );
+    IF_RET( !view.size || view.size > UINT32_MAX );
 
     // growing buffer for each thread
     static thread_local utils::Buffer buffer;
@@ -203,8 +251,11 @@ utils::FileView utils::fromFileP( const sys_string& filename ) {
     size_t bytes = _read( file, ptr, offset );
     IF_RET( offset != bytes );
 
-    // check first 300 bytes for binary
-    IF_RET( !utils::isTextFile( std::string_view( ptr, std::min<size_t>( offset, 300ul ) ) ) );
+    // check first 300 bytes for binary, UTF-16 text has zeros, too
+    const std::string_view head( ptr, std::min<size_t>( offset, 300ul ) );
+    view.encoding = utils::detectEncoding( head );
+    view.binary = view.encoding == Encoding::Utf8 && !utils::isTextFile( head );
+    IF_RET( view.binary );
 
     // read rest
     if( view.size > offset ) {
@@ -217,8 +268,44 @@ utils::FileView utils::fromFileP( const sys_string& filename ) {
     return view;
 }
 
+#ifndef _WIN32
+utils::FileView utils::fromMmap( const sys_string& filename ) {
+    FileView view;
+    int file = open( filename.c_str(), O_RDONLY | O_BINARY );
+    IF_RET( file == -1 );
+    utils::ScopeGuard onExit( [file] { close( file ); } );
+
+    // match offsets are 32 bit
+    view.size = utils::fileSize( file );
+    IF_RET( !view.size || view.size > UINT32_MAX );
+
+    // mapping costs more than reading small files, and the SSE kernels read up to 16 bytes behind
+    // the content, which must stay within the last page
+    static const size_t page = sysconf( _SC_PAGESIZE );
+
+    if( view.size < 64_kB || view.size % page == 0 || page - view.size % page < 16 ) {
+        static thread_local utils::Buffer buffer;
+        char* ptr = buffer.grow( view.size );
+        size_t bytes = _read( file, ptr, view.size );
+        IF_RET( view.size != bytes );
+
+        view.content = std::string_view( ptr, view.size );
+        return view;
+    }
+
+    void* ptr = mmap( nullptr, view.size, PROT_READ, MAP_PRIVATE, file, 0 );
+    IF_RET( ptr == MAP_FAILED );
+    madvise( ptr, view.size, MADV_SEQUENTIAL );
+
+    const size_t size = view.size;
+    view.mapping = std::shared_ptr<void>( ptr, [size]( void* ptr ) { munmap( ptr, size ); } );
+    view.content = std::string_view( static_cast<const char*>( ptr ), view.size );
+    return view;
+}
+#endif
+
 #ifdef _WIN32
-utils::FileView utils::fromWinAPI( const sys_string& filename ) {
+utils::FileView utils::fromWinAPI( const sys_string& filename, const bool binary ) {
     utils::FileView view;
     HANDLE file = ::CreateFileW( filename.c_str(),      // file to open
                                  GENERIC_READ,          // open for reading
@@ -231,8 +318,10 @@ utils::FileView utils::fromWinAPI( const sys_string& filename ) {
     IF_RET( file == INVALID_HANDLE_VALUE );
     utils::ScopeGuard onExit( [file] { ::CloseHandle( file ); } );
 
-    view.size = ::GetFileSize( file, nullptr );
-    IF_RET( !view.size );
+    // match offsets are 32 bit
+    DWORD high = 0;
+    view.size = ::GetFileSize( file, &high );
+    IF_RET( !view.size || high );
 
     // growing buffer for each thread
     static thread_local utils::Buffer buffer;
@@ -248,8 +337,13 @@ utils::FileView utils::fromWinAPI( const sys_string& filename ) {
                           nullptr );
     IF_RET( !ok );
 
-    // check first 300 bytes for binary
-    IF_RET( !utils::isTextFile( std::string_view( ptr, std::min<size_t>( offset, 300ul ) ) ) );
+    // check first 300 bytes for binary, UTF-16 text has zeros, too
+    if( !binary ) {
+        const std::string_view head( ptr, std::min<size_t>( offset, 300ul ) );
+        view.encoding = utils::detectEncoding( head );
+        view.binary = view.encoding == Encoding::Utf8 && !utils::isTextFile( head );
+        IF_RET( view.binary );
+    }
 
     // read rest
     if( view.size > offset ) {
@@ -266,8 +360,13 @@ utils::FileView utils::fromWinAPI( const sys_string& filename ) {
 }
 #endif
 
-#ifndef _WIN32
 void utils::recurseDir( const sys_string& filename, const std::function<void( const sys_string& filename )>& callback ) {
+    const std::atomic_bool never = {false};
+    recurseDir( filename, callback, never );
+}
+
+#ifndef _WIN32
+void utils::recurseDir( const sys_string& filename, const std::function<void( const sys_string& filename )>& callback, const std::atomic_bool& cancelled ) {
     DIR* dir = opendir( filename.c_str() );
 
     if( !dir ) { return; }
@@ -277,7 +376,7 @@ void utils::recurseDir( const sys_string& filename, const std::function<void( co
 
     struct dirent* dp = nullptr;
 
-    while( ( dp = readdir( dir ) ) != nullptr ) {
+    while( !cancelled && ( dp = readdir( dir ) ) != nullptr ) {
 
         if( dp->d_type == DT_REG ) {
             callback( filename + slash + dp->d_name );
@@ -295,7 +394,7 @@ void utils::recurseDir( const sys_string& filename, const std::function<void( co
 
             if( !strcmp( dp->d_name, ".hg" ) ) { continue; }
 
-            utils::recurseDir( filename + slash + dp->d_name, callback );
+            utils::recurseDir( filename + slash + dp->d_name, callback, cancelled );
             continue;
         }
 
@@ -305,7 +404,7 @@ void utils::recurseDir( const sys_string& filename, const std::function<void( co
     closedir( dir );
 }
 #else
-void utils::recurseDir( const sys_string& filename, const std::function<void ( const sys_string& filename )>& callback ) {
+void utils::recurseDir( const sys_string& filename, const std::function<void ( const sys_string& filename )>& callback, const std::atomic_bool& cancelled ) {
     WIN32_FIND_DATAW data = {};
 
     std::wstring withGlob = filename + L"\\*";
@@ -313,7 +412,7 @@ void utils::recurseDir( const sys_string& filename, const std::function<void ( c
 
     if( !file ) { return; }
 
-    while( FindNextFileW( file, &data ) ) {
+    while( !cancelled && FindNextFileW( file, &data ) ) {
 
         if( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) {
             if( !wcscmp( data.cFileName, L".." ) ) { continue; }
@@ -324,7 +423,7 @@ void utils::recurseDir( const sys_string& filename, const std::function<void ( c
 
             if( !wcscmp( data.cFileName, L".hg" ) ) { continue; }
 
-            recurseDir( filename + data.cFileName + L"\\", callback );
+            recurseDir( filename + data.cFileName + L"\\", callback, cancelled );
             continue;
         }
 
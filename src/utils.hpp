@@ -1,9 +1,11 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 #include <iostream>
 #include <functional>
 #include <vector>
+#include <memory>
 
 #ifdef _WIN32
 #include <io.h>
@@ -92,10 +94,19 @@ struct Buffer {
 
 using Lines = std::vector<std::string_view>;
 
+enum class Encoding {
+    Utf8,    // or ASCII, Latin-1...
+    Utf16LE,
+    Utf16BE
+};
+
 struct FileView {
     size_t size = 0;
     Lines lines;
     std::string_view content;
+    Encoding encoding = Encoding::Utf8;
+    bool binary = false;           // skipped as binary w/out content
+    std::shared_ptr<void> mapping; // unmaps content, if it's mmapped
 };
 
 //! prints text in color to stdout
@@ -105,9 +116,15 @@ void printColor( Color color, const std::string& text );
 //! \returns output of command as vector
 void gitLsFiles( const boost::filesystem::path& path, const std::function<void( const sys_string& filename )>& callback );
 
+//! like gitLsFiles, but stops, once cancelled is set
+void gitLsFiles( const boost::filesystem::path& path, const std::function<void( const sys_string& filename )>& callback, const std::atomic_bool& cancelled );
+
 //! \returns true, if filename has no "\0\0" in the first 1000 bytes
 bool isTextFile( const std::string_view& content );
 
+//! \returns UTF-16 encoding, if content starts with a BOM or has a zero in every other byte
+Encoding detectEncoding( const std::string_view& content );
+
 #define IF_RET( A ) if( A ) { view.size = 0; return view; }
 
 //! \returns content of filename as vector with C API
@@ -115,7 +132,11 @@ FileView fromFileP( const sys_string& filename );
 
 #ifdef _WIN32
 //! \returns content of filename as vector with WINAPI
-FileView fromWinAPI( const sys_string& filename );
+//! \param binary if true, binaries are read, too
+FileView fromWinAPI( const sys_string& filename, const bool binary = false );
+#else
+//! \returns content of filename incl. binaries for --binary, mmapped or read, if it's small
+FileView fromMmap( const sys_string& filename );
 #endif
 
 //! splits content at newlines
@@ -147,6 +168,9 @@ bool openFile( const sys_string& filename );
 //! \note on windows, filename must end with a path separator
 void recurseDir( const sys_string& filename, const std::function<void( const sys_string& filename )>& callback );
 
+//! like recurseDir, but stops, once cancelled is set
+void recurseDir( const sys_string& filename, const std::function<void( const sys_string& filename )>& callback, const std::atomic_bool& cancelled );
+
 sys_string absolutePath( const sys_string& filename = DOT );
 
 }
@@ -11,6 +11,7 @@ macx:  include( $${PRI_DIR}/mac.pri )
 
 include( $${PRI_DIR}/unit_test.pri )
 include( $${PRI_DIR}/boost.pri )
+equals( WITH_PCRE2, 1 ): include( $${PRI_DIR}/pcre2.pri )
 
 # testsuite
 SOURCES += ../src/TestPerformance.cpp
@@ -32,6 +33,7 @@ SOURCES += $${MAIN_DIR}/src/pipes.cpp
 
 HEADERS += $${MAIN_DIR}/src/mischasan.hpp
 HEADERS += $${MAIN_DIR}/src/stdstr.hpp
+HEADERS += $${MAIN_DIR}/src/bitap.hpp
 
 !win32: HEADERS += $${MAIN_DIR}/src/nftwwalker.hpp
 !win32: HEADERS += $${MAIN_DIR}/src/ftswalker.hpp
@@ -9,6 +9,7 @@
 #include "threadpool.hpp"
 
 using fromFileFunc = utils::FileView( const sys_string& filename );
+using recurseDirFunc = void( const sys_string& filename, const std::function<void( const sys_string& filename )>& callback );
 using Result = std::pair<long, std::string>;
 
 inline void printSorted( std::vector<Result>& results ) {
@@ -38,7 +39,7 @@ inline Result timed1000( const std::string& name, const std::function<void()>& f
     return { ns, utils::format( "%17s : %6ld us\n", name.c_str(), ns / 1000 ) };
 }
 
-inline Result runDirWalkerTest( const std::string& name, const decltype( utils::recurseDir )& func ) {
+inline Result runDirWalkerTest( const std::string& name, const recurseDirFunc& func ) {
     std::atomic_size_t files = 0;
     std::atomic_size_t bytes = 0;
     fs::path include = "../../../../libs/boost/include/";
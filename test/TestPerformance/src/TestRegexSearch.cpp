@@ -9,10 +9,15 @@
 #include <regex.h>
 #endif
 
+#if WITH_PCRE2
+#include "pcre2.h"
+#endif
+
 #include "PerformanceUtils.hpp"
 #include "utils.hpp"
 #include "types.hpp"
 #include "licence.hpp"
+#include "bitap.hpp"
 
 #if !BOOST_OS_WINDOWS
 // http://pubs.opengroup.org/onlinepubs/9699919799/functions/regcomp.html
@@ -71,6 +76,48 @@ size_t boostXpressive( const std::string& content, const std::string& term ) {
     return count;
 }
 
+#if WITH_PCRE2
+size_t pcre2Regex( const std::string& content, const std::string& term, const bool jit ) {
+
+    int error = 0;
+    PCRE2_SIZE offset = 0;
+    pcre2_code* code = pcre2_compile( ( PCRE2_SPTR )term.data(), term.size(), PCRE2_MULTILINE, &error, &offset, nullptr );
+
+    if( jit ) { pcre2_jit_compile( code, PCRE2_JIT_COMPLETE ); }
+
+    pcre2_match_data* data = pcre2_match_data_create_from_pattern( code, nullptr );
+
+    size_t count = 0;
+    offset = 0;
+
+    while( pcre2_match( code, ( PCRE2_SPTR )content.data(), content.size(), offset, 0, data, nullptr ) >= 0 ) {
+        ++count;
+        const PCRE2_SIZE* ovector = pcre2_get_ovector_pointer( data );
+        offset = ovector[1] > ovector[0] ? ovector[1] : ovector[1] + 1;
+    }
+
+    pcre2_match_data_free( data );
+    pcre2_code_free( code );
+
+    return count;
+}
+#endif
+
+size_t bitapRegex( const std::string& content, const std::string& term ) {
+
+    bitap::Pattern pattern;
+    bitap::compile( term, false, pattern );
+
+    size_t count = 0;
+
+    bitap::find( content, pattern, [&count]( size_t, size_t ) {
+        ++count;
+        return true;
+    } );
+
+    return count;
+}
+
 size_t stdRegex( const std::string& content, const std::string& term ) {
 
     std::regex regex( term );
@@ -117,8 +164,61 @@ BOOST_AUTO_TEST_CASE( Test_regex ) {
         timed1000( "std::regex", [&text, &term, &count] {
             count = stdRegex( text, term );
         }, check ),
+
+        timed1000( "bitap", [&text, &term, &count] {
+            count = bitapRegex( text, term );
+        }, check ),
+
+#if WITH_PCRE2
+        timed1000( "pcre2", [&text, &term, &count] {
+            count = pcre2Regex( text, term, false );
+        }, check ),
+
+        timed1000( "pcre2 jit", [&text, &term, &count] {
+            count = pcre2Regex( text, term, true );
+        }, check ),
+#endif
     };
 
     printSorted( results );
     printf( "\n" );
 }
+
+#if WITH_PCRE2
+// compare fsrc's regex engines on different pattern classes
+BOOST_AUTO_TEST_CASE( Test_regexEngines ) {
+    std::string text( ( const char* )licence, sizeof( licence ) );
+
+    const std::vector<std::pair<std::string, std::string>> patterns = {
+        {"class", "[Ll]icense"},
+        {"alternation", "copyright|patent|trademark"},
+        {"lookahead", "\\w+(?= License)"},
+        {"anchored", "^\\s+[0-9]+\\. \\w+"},
+    };
+
+    for( const auto& pattern : patterns ) {
+        printf( "Regex engines on %s\n", pattern.first.c_str() );
+
+        const std::string& term = pattern.second;
+        const size_t expected = boostRegex( text, term );
+        size_t count = 0;
+
+        auto check = [&] {
+            BOOST_CHECK_EQUAL( count, expected );
+        };
+
+        std::vector<Result> results = {
+            timed1000( "boost::regex", [&text, &term, &count] {
+                count = boostRegex( text, term );
+            }, check ),
+
+            timed1000( "pcre2 jit", [&text, &term, &count] {
+                count = pcre2Regex( text, term, true );
+            }, check ),
+        };
+
+        printSorted( results );
+        printf( "\n" );
+    }
+}
+#endif
@@ -37,6 +37,7 @@ BOOST_AUTO_TEST_CASE( Test_find ) {
         const char* ptr = nullptr;
         std::string::const_iterator it = text.cend();
 
+        sse::ShortKernel<11> kernel( term );
         boost::algorithm::boyer_moore_horspool bmh( term.begin(), term.end() );
         boost::algorithm::knuth_morris_pratt kmp( term.begin(), term.end() );
         std::boyer_moore_searcher bms( term.begin(), term.end() );
@@ -75,6 +76,14 @@ BOOST_AUTO_TEST_CASE( Test_find ) {
             }, checks ),
 #endif
 
+            timed1000( "sse::ShortKernel", [&view, &kernel, &ptr] {
+                ptr = nullptr;
+                kernel.find( view, [&view, &ptr]( size_t from, size_t ) {
+                    ptr = view.data() + from;
+                    return false;
+                } );
+            }, checks ),
+
             timed1000( "strstr", [&text, &term, &ptr] {
                 ptr = strstr( text.data(), term.data() );
             }, checks ),
@@ -101,3 +110,103 @@ BOOST_AUTO_TEST_CASE( Test_find ) {
         printf( "\n" );
     }
 }
+
+BOOST_AUTO_TEST_CASE( Test_findLong ) {
+    printf( "Long string search\n" );
+
+    std::string text( ( const char* )licence, sizeof( licence ) );
+
+    // a line, a paragraph and a paragraph w/ a typo at the end
+    const std::string line = "permanently, unless and until the copyright holder explicitly and";
+    const size_t from = text.find( "  Termination of your rights" );
+    const std::string paragraph = text.substr( from, 400 );
+    const std::string typo = paragraph.substr( 0, 399 ) + "#";
+
+    for( const std::string& term : { line, paragraph, typo } ) {
+        const size_t expected = text.find( term );
+        size_t pos = std::string::npos;
+
+        sse::LongKernel kernel( term );
+        boost::algorithm::boyer_moore_horspool bmh( term.begin(), term.end() );
+        boost::algorithm::knuth_morris_pratt kmp( term.begin(), term.end() );
+
+        auto checks = [&] {
+            BOOST_REQUIRE_EQUAL( pos, expected );
+        };
+
+        std::vector<Result> results = {
+            timed1000( "find", [&text, &term, &pos] {
+                pos = text.find( term );
+            }, checks ),
+
+            timed1000( "sse::LongKernel", [&text, &kernel, &pos] {
+                pos = std::string::npos;
+                kernel.find( text, [&pos]( size_t from, size_t ) {
+                    pos = from;
+                    return false;
+                } );
+            }, checks ),
+
+#if !BOOST_OS_WINDOWS
+            timed1000( "memmem", [&text, &term, &pos] {
+                const char* ptr = ( char* )memmem( text.data(), text.size(), term.data(), term.size() );
+                pos = ptr ? ptr - text.data() : std::string::npos;
+            }, checks ),
+#endif
+
+            timed1000( "strstr", [&text, &term, &pos] {
+                const char* ptr = strstr( text.data(), term.data() );
+                pos = ptr ? ptr - text.data() : std::string::npos;
+            }, checks ),
+
+            timed1000( "BMH search", [&text, &pos, &bmh] {
+                const auto it = bmh( text.cbegin(), text.cend() ).first;
+                pos = it == text.cend() ? std::string::npos : it - text.cbegin();
+            }, checks ),
+
+            timed1000( "KMP search", [&text, &pos, &kmp] {
+                const auto it = kmp( text.cbegin(), text.cend() ).first;
+                pos = it == text.cend() ? std::string::npos : it - text.cbegin();
+            }, checks ),
+        };
+
+        printSorted( results );
+        printf( "\n" );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( Test_count ) {
+    printf( "Char count\n" );
+
+    std::string text( ( const char* )licence, sizeof( licence ) );
+    const size_t expected = std::count( text.cbegin(), text.cend(), 'e' );
+    size_t found = 0;
+
+    auto checks = [&] {
+        BOOST_REQUIRE_EQUAL( found, expected );
+    };
+
+    std::vector<Result> results = {
+        timed1000( "std::count", [&text, &found] {
+            found = std::count( text.cbegin(), text.cend(), 'e' );
+        }, checks ),
+
+        timed1000( "memchr", [&text, &found] {
+            found = 0;
+            const char* ptr = text.data();
+            const char* end = text.data() + text.size();
+
+            while( ( ptr = static_cast<const char*>( memchr( ptr, 'e', end - ptr ) ) ) ) {
+                ++found;
+                ++ptr;
+            }
+        }, checks ),
+
+        timed1000( "sse::count", [&text, &found] {
+            found = sse::count( text, 'e' );
+        }, checks ),
+    };
+
+    printSorted( results );
+    printf( "\n" );
+}
@@ -21,5 +21,31 @@ SOURCES += $${SRC_DIR}/utils.cpp
 HEADERS += $${SRC_DIR}/globmatcher.hpp
 SOURCES += $${SRC_DIR}/globmatcher.cpp
 HEADERS += $${SRC_DIR}/pipes.hpp
+HEADERS += $${SRC_DIR}/bitap.hpp
+HEADERS += $${SRC_DIR}/myers.hpp
+HEADERS += $${SRC_DIR}/utf8.hpp
+HEADERS += $${SRC_DIR}/utf16.hpp
+HEADERS += $${SRC_DIR}/ssefind.hpp
+HEADERS += $${SRC_DIR}/linescanner.hpp
+HEADERS += $${SRC_DIR}/query.hpp
+SOURCES += $${SRC_DIR}/query.cpp
+HEADERS += $${SRC_DIR}/trigramindex.hpp
+HEADERS += $${SRC_DIR}/fingerprints.hpp
+HEADERS += $${SRC_DIR}/printer/streamprinter.hpp
+HEADERS += $${SRC_DIR}/searcher/casesensitivesearcher.hpp
+HEADERS += $${SRC_DIR}/searcher/caseinsensitivesearcher.hpp
+HEADERS += $${SRC_DIR}/searcher/regexsearcher.hpp
+HEADERS += $${SRC_DIR}/searchoptions.hpp
+SOURCES += $${SRC_DIR}/searchoptions.cpp
+HEADERS += $${SRC_DIR}/searchcontroller.hpp
+SOURCES += $${SRC_DIR}/searchcontroller.cpp
+HEADERS += $${SRC_DIR}/threadpool.hpp
+SOURCES += $${SRC_DIR}/threadpool.cpp
+SOURCES += $${SRC_DIR}/trigramindex.cpp
+SOURCES += $${SRC_DIR}/fingerprints.cpp
+HEADERS += $${SRC_DIR}/metadatacache.hpp
+SOURCES += $${SRC_DIR}/metadatacache.cpp
+HEADERS += $${SRC_DIR}/server.hpp
+SOURCES += $${SRC_DIR}/server.cpp
 SOURCES += $${SRC_DIR}/pipes.cpp
 macx: SOURCES += $${SRC_DIR}/macutils.mm
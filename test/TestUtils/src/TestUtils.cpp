@@ -4,8 +4,27 @@
 
 #include "utils.hpp"
 #include "globmatcher.hpp"
+#include "bitap.hpp"
+#include "myers.hpp"
+#include "utf8.hpp"
+#include "utf16.hpp"
+#include "ssefind.hpp"
+#include "linescanner.hpp"
+#include "query.hpp"
+#include "trigramindex.hpp"
+#include "fingerprints.hpp"
+#include "printer/streamprinter.hpp"
+#include "searcher/casesensitivesearcher.hpp"
+#include "searcher/caseinsensitivesearcher.hpp"
+#include "searcher/regexsearcher.hpp"
+#include "searchcontroller.hpp"
+#include "threadpool.hpp"
+
+#include "boost/regex.hpp"
 
 #include <fstream>
+#include <random>
+#include <set>
 
 BOOST_AUTO_TEST_CASE( Test_isTextFile ) {
 
@@ -50,6 +69,38 @@ BOOST_AUTO_TEST_CASE( Test_parseContent ) {
     BOOST_CHECK_EQUAL( lines.size(), 4 );
 }
 
+BOOST_AUTO_TEST_CASE( Test_lineScanner ) {
+    const std::string_view content = "123\n\nab ab\r\n\nlast";
+    search::Lines lines;
+    search::LineScanner scanner( content, lines );
+
+    for( const size_t from : { 0, 1, 5, 8, 13, 15 } ) { scanner.add( from, from + 1 ); }
+
+    BOOST_REQUIRE_EQUAL( lines.size(), 3 );
+    BOOST_CHECK_EQUAL( lines[0].number, 1 );
+    BOOST_CHECK_EQUAL( lines[0].view( content ), "123" );
+    BOOST_CHECK_EQUAL( lines[1].number, 3 );
+    BOOST_CHECK_EQUAL( lines[1].view( content ), "ab ab\r" );
+    BOOST_CHECK_EQUAL( lines[2].number, 5 );
+    BOOST_CHECK_EQUAL( lines[2].view( content ), "last" );
+
+    // an empty match at a newline belongs to the next line
+    search::LineScanner again( content, lines );
+    again.add( 11, 11 );
+    BOOST_REQUIRE_EQUAL( lines.size(), 1 );
+    BOOST_CHECK_EQUAL( lines[0].number, 4 );
+    BOOST_CHECK_EQUAL( lines[0].view( content ), "" );
+
+    // matches across lines span all their lines
+    search::LineScanner across( content, lines );
+    across.add( 1, 7 );   // "23\n\nab"
+    across.add( 10, 12 ); // "\r\n" continues the line
+    across.add( 12, 13 ); // "\n" of the empty line
+    BOOST_REQUIRE_EQUAL( lines.size(), 1 );
+    BOOST_CHECK_EQUAL( lines[0].number, 1 );
+    BOOST_CHECK_EQUAL( lines[0].view( content ), "123\n\nab ab\r\n\nlast" );
+}
+
 BOOST_AUTO_TEST_CASE( Test_recurseDir ) {
 
     fs::path dir = fs::temp_directory_path( ) / "test_recurseDir";
@@ -65,10 +116,19 @@ BOOST_AUTO_TEST_CASE( Test_recurseDir ) {
         ++counter;
         utils::FileView view = utils::fromFileP( filename );
         BOOST_CHECK_EQUAL( std::string( view.content ), content );
+        BOOST_CHECK( !view.binary );
     } );
 
 
     BOOST_CHECK_EQUAL( counter, 1 );
+
+    // binaries are skipped w/out content
+    fs::path binary = dir / "test.bin";
+    { boost::filesystem::ofstream( binary ) << std::string( "ha\0\0se", 6 ); }
+
+    utils::FileView view = utils::fromFileP( binary.native() );
+    BOOST_CHECK( view.binary );
+    BOOST_CHECK_EQUAL( view.size, 0 );
 }
 
 BOOST_AUTO_TEST_CASE( Test_recurseGit ) {
@@ -144,3 +204,650 @@ BOOST_AUTO_TEST_CASE( Test_glob ) {
     GlobMatcher matcher3( "boost*.cmake" );
     BOOST_CHECK( matcher3.matches( "/tmp/cmake/boost.cmake" ) );
 }
+
+BOOST_AUTO_TEST_CASE( Test_bitap ) {
+    bitap::Pattern pattern;
+    BOOST_CHECK( !bitap::compile( "a.c", false, pattern ) );
+    BOOST_CHECK( !bitap::compile( "a|c", false, pattern ) );
+    BOOST_CHECK( !bitap::compile( "a??", false, pattern ) );
+    BOOST_CHECK( !bitap::compile( "a?", false, pattern ) );
+    BOOST_CHECK( !bitap::compile( "\\bword", false, pattern ) );
+    BOOST_CHECK( !bitap::compile( "[[:alpha:]]", false, pattern ) );
+
+    const std::string text = "The color and the colour of the License, licence\nand LICENSE.\n"
+                             "colouur col0r c-l or [x] aab ab b a";
+
+    // bitap must find the same matches as boost::regex
+    for( const bool ignoreCase : { false, true } ) {
+        for( const std::string term : { "[Ll]icense", "colou?r", "colou?u?r", "c[^a-z ]l", "licen[cs]e", "\\[x\\]",
+                                        "a?a?b", "[]x]", "col\\d?r", "\\w\\s\\w", "o?r" } ) {
+            BOOST_REQUIRE( bitap::compile( term, ignoreCase, pattern ) );
+
+            std::vector<std::pair<size_t, size_t>> expected;
+            boost::regex regex( term, ignoreCase ? boost::regex::icase : boost::regex::normal );
+
+            for( boost::sregex_iterator it( text.cbegin(), text.cend(), regex ), end; it != end; ++it ) {
+                expected.emplace_back( it->position(), it->position() + it->length() );
+            }
+
+            std::vector<std::pair<size_t, size_t>> found;
+            bitap::find( text, pattern, [&found]( size_t from, size_t to ) {
+                found.emplace_back( from, to );
+                return true;
+            } );
+
+            BOOST_CHECK_MESSAGE( found == expected, term );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( Test_myers ) {
+    // Levenshtein distance for reference
+    auto distance = []( const std::string & a, const std::string & b ) {
+        std::vector<size_t> row( b.size() + 1 );
+
+        for( size_t j = 0; j <= b.size(); ++j ) { row[j] = j; }
+
+        for( size_t i = 1; i <= a.size(); ++i ) {
+            size_t diagonal = row[0];
+            row[0] = i;
+
+            for( size_t j = 1; j <= b.size(); ++j ) {
+                size_t above = row[j];
+                row[j] = std::min( { row[j] + 1, row[j - 1] + 1, diagonal + ( a[i - 1] == b[j - 1] ? 0 : 1 ) } );
+                diagonal = above;
+            }
+        }
+
+        return row.back();
+    };
+
+    myers::Pattern pattern;
+    BOOST_CHECK( !myers::compile( "", false, pattern ) );
+    BOOST_CHECK( !myers::compile( std::string( 65, 'x' ), false, pattern ) );
+
+    const std::string text = "The quick brown fox, the quikc brwn fox and the qiuck fox jumps over the QUICK dog";
+    std::vector<std::string> found;
+
+    auto find = [&]( const std::string & term, const size_t errors, const bool ignoreCase ) {
+        found.clear();
+        BOOST_REQUIRE( myers::compile( term, ignoreCase, pattern ) );
+        myers::find( text, 0, text.size(), pattern, errors, [&]( size_t from, size_t to ) {
+            found.emplace_back( text.substr( from, to - from ) );
+            return true;
+        } );
+    };
+
+    find( "quick", 0, false );
+    BOOST_CHECK_EQUAL( found.size(), 1 );
+
+    find( "quick", 2, false );
+    BOOST_CHECK_EQUAL( found.size(), 3 );
+
+    find( "quick", 2, true );
+    BOOST_CHECK_EQUAL( found.size(), 4 );
+    BOOST_CHECK_EQUAL( found.back(), "QUICK" );
+
+    find( "brown", 1, false );
+    BOOST_REQUIRE_EQUAL( found.size(), 2 );
+    BOOST_CHECK_EQUAL( found[0], "brown" );
+    BOOST_CHECK_EQUAL( found[1], "brwn" );
+
+    // every match is within the edit distance
+    for( const std::string term : { "fox", "quick", "the", "jumps over" } ) {
+        find( term, 1, false );
+
+        for( const std::string& match : found ) {
+            BOOST_CHECK_LE( distance( match, term ), 1 );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( Test_utf8 ) {
+    BOOST_CHECK( !utf8::hasUpper( "größe", false ) );
+    BOOST_CHECK( utf8::hasUpper( "grÖße", false ) );
+    BOOST_CHECK( utf8::hasUpper( "Straße", false ) );
+    BOOST_CHECK( utf8::hasUpper( "\\W+", false ) );
+    BOOST_CHECK( !utf8::hasUpper( "\\W+\\S", true ) );
+    BOOST_CHECK( utf8::hasUpper( "\\W+Foo", true ) );
+
+    BOOST_CHECK( utf8::fold( U'A' ) == U'a' );
+    BOOST_CHECK( utf8::fold( U'Ä' ) == U'ä' );
+    BOOST_CHECK( utf8::fold( U'ẞ' ) == U'ß' );
+    BOOST_CHECK( utf8::fold( U'İ' ) == U'i' );
+    BOOST_CHECK( utf8::fold( U'ı' ) == U'i' );
+    BOOST_CHECK( utf8::fold( U'Ş' ) == U'ş' );
+    BOOST_CHECK( utf8::fold( U'Ğ' ) == U'ğ' );
+    BOOST_CHECK( utf8::fold( U'Ł' ) == U'ł' );
+    BOOST_CHECK( utf8::fold( U'Σ' ) == U'σ' );
+    BOOST_CHECK( utf8::fold( U'ς' ) == U'σ' );
+    BOOST_CHECK( utf8::fold( U'Ж' ) == U'ж' );
+    BOOST_CHECK( utf8::fold( U'Ё' ) == U'ё' );
+    BOOST_CHECK( utf8::fold( U'K' ) == U'k' );
+    BOOST_CHECK( utf8::fold( U'中' ) == U'中' );
+    BOOST_CHECK( utf8::fold( U'Ə' ) == U'ə' );
+    BOOST_CHECK( utf8::fold( U'Ș' ) == U'ș' );
+    BOOST_CHECK( utf8::fold( U'Ǆ' ) == U'ǆ' );
+    BOOST_CHECK( utf8::fold( U'ǅ' ) == U'ǆ' );
+    BOOST_CHECK( utf8::fold( U'Ǎ' ) == U'ǎ' );
+    BOOST_CHECK( utf8::fold( U'Ƀ' ) == U'ƀ' );
+    BOOST_CHECK( utf8::fold( U'ǎ' ) == U'ǎ' );
+
+    BOOST_CHECK( utf8::isAscii( "plain ASCII text, which is longer than 16 bytes" ) );
+    BOOST_CHECK( !utf8::isAscii( "plain ASCII text, which is longer than 16 bytes, ä" ) );
+
+    std::string encoded;
+    char32_t decoded = 0;
+    size_t length = 0;
+
+    for( char32_t c : {U'a', U'ü', U'€', U'😀'} ) {
+        encoded.clear();
+        utf8::encode( c, encoded );
+        BOOST_REQUIRE( utf8::decode( reinterpret_cast<const unsigned char*>( encoded.data() ), encoded.size(), decoded, length ) );
+        BOOST_CHECK( decoded == c );
+        BOOST_CHECK_EQUAL( length, encoded.size() );
+    }
+
+    // overlong and truncated
+    BOOST_CHECK( !utf8::decode( reinterpret_cast<const unsigned char*>( "\xC0\xAF" ), 2, decoded, length ) );
+    BOOST_CHECK( !utf8::decode( reinterpret_cast<const unsigned char*>( "\xE2\x82" ), 2, decoded, length ) );
+
+    utf8::Pattern pattern;
+    BOOST_CHECK( !utf8::compile( "", pattern ) );
+
+    const std::string text = "Größe, GRÖSSE, GRÖẞE und größe; İstanbul, ISTANBUL, ıstanbul; Σίσυφος, ΣΊΣΥΦΟΣ";
+    std::vector<std::string> found;
+
+    auto find = [&]( const std::string & term ) {
+        found.clear();
+        BOOST_REQUIRE( utf8::compile( term, pattern ) );
+        utf8::find( text, pattern, [&]( size_t from, size_t to ) {
+            found.emplace_back( text.substr( from, to - from ) );
+            return true;
+        } );
+    };
+
+    find( "größe" );
+    BOOST_REQUIRE_EQUAL( found.size(), 3 );
+    BOOST_CHECK_EQUAL( found[0], "Größe" );
+    BOOST_CHECK_EQUAL( found[1], "GRÖẞE" );
+    BOOST_CHECK_EQUAL( found[2], "größe" );
+
+    find( "İstanbul" );
+    BOOST_CHECK_EQUAL( found.size(), 3 );
+
+    find( "σίσυφος" );
+    BOOST_REQUIRE_EQUAL( found.size(), 2 );
+    BOOST_CHECK_EQUAL( found[1], "ΣΊΣΥΦΟΣ" );
+
+    find( "ÖSS" );
+    BOOST_REQUIRE_EQUAL( found.size(), 1 );
+    BOOST_CHECK_EQUAL( found[0], "ÖSS" );
+}
+
+BOOST_AUTO_TEST_CASE( Test_utf16 ) {
+    const std::string text = "first\r\nGrüße 😀\r\nnothing\r\nlast Grüße";
+    const std::string le = utf16::fromUtf8( text, false );
+    const std::string be = utf16::fromUtf8( text, true );
+    BOOST_CHECK_EQUAL( le.size(), 2 * ( text.size() - 6 ) ); // ü, ß and 😀 are shorter in UTF-16
+
+    BOOST_CHECK( utils::detectEncoding( "\xFF\xFE" + le ) == utils::Encoding::Utf16LE );
+    BOOST_CHECK( utils::detectEncoding( "\xFE\xFF" + be ) == utils::Encoding::Utf16BE );
+    BOOST_CHECK( utils::detectEncoding( le ) == utils::Encoding::Utf16LE );
+    BOOST_CHECK( utils::detectEncoding( be ) == utils::Encoding::Utf16BE );
+    BOOST_CHECK( utils::detectEncoding( text ) == utils::Encoding::Utf8 );
+    BOOST_CHECK( utils::detectEncoding( std::string( "\x01\0\x02\0\0\0\x03\0", 8 ) ) == utils::Encoding::Utf8 );
+
+    std::string out;
+
+    // everything
+    BOOST_CHECK( utf16::toUtf8( "\xFF\xFE" + le, false, "", out ) );
+    BOOST_CHECK_EQUAL( out, text );
+
+    // only lines with term, others stay empty
+    BOOST_CHECK( utf16::toUtf8( be, true, utf16::fromUtf8( "Grüße", true ), out ) );
+    BOOST_CHECK_EQUAL( out, "\nGrüße 😀\r\n\nlast Grüße" );
+
+    // term must be aligned to units
+    BOOST_CHECK( !utf16::toUtf8( le, false, std::string( "\0i", 2 ), out ) );
+    BOOST_CHECK( !utf16::toUtf8( le, false, utf16::fromUtf8( "missing", false ), out ) );
+}
+
+//! checks, that Kernel finds the same, also overlapping, occurrences as std::string::find
+template<typename Kernel>
+void checkKernel( const std::string& text, const std::string& term ) {
+    std::vector<size_t> expected;
+
+    for( size_t pos = text.find( term ); pos != std::string::npos; pos = text.find( term, pos + 1 ) ) { expected.push_back( pos ); }
+
+    std::vector<size_t> found;
+    Kernel( term ).find( text, [&found, &term]( size_t from, size_t to ) {
+        BOOST_CHECK_EQUAL( to - from, term.size() );
+        found.push_back( from );
+        return true;
+    } );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( found.cbegin(), found.cend(), expected.cbegin(), expected.cend() );
+}
+
+BOOST_AUTO_TEST_CASE( Test_kernel ) {
+    // long enough for the 64 and 16 byte steps and the scalar tail
+    std::string text;
+
+    for( size_t i = 0; i < 20; ++i ) { text += "aaaab size_t BOOST_ASSERT( ab ) namespace xyz\n"; }
+
+    checkKernel<sse::ShortKernel<2>>( text, "ab" );
+    checkKernel<sse::ShortKernel<3>>( text, "aaa" ); // overlapping
+    checkKernel<sse::ShortKernel<6>>( text, "size_t" );
+    checkKernel<sse::ShortKernel<9>>( text, "namespace" );
+    checkKernel<sse::ShortKernel<12>>( text, "BOOST_ASSERT" );
+    checkKernel<sse::ShortKernel<16>>( text, "ASSERT( ab ) nam" );
+    checkKernel<sse::ShortKernel<4>>( text, "xyz\n" ); // at the end
+    checkKernel<sse::ShortKernel<5>>( text, "zzzzz" );
+
+    // long terms with and w/out Horspool skips
+    std::string line = "aaaab size_t BOOST_ASSERT( ab ) namespace xyz\n";
+    checkKernel<sse::LongKernel>( text, line );
+    checkKernel<sse::LongKernel>( text, line + line + line );
+    checkKernel<sse::LongKernel>( text, std::string( 40, 'a' ) );
+    checkKernel<sse::LongKernel>( std::string( 300, 'a' ), std::string( 100, 'a' ) ); // overlapping
+    checkKernel<sse::LongKernel>( text, "xyz\naaaab size_t BOOST_ASSERT" );
+    checkKernel<sse::LongKernel>( text, text.substr( 1 ) );
+    checkKernel<sse::LongKernel>( text, text );
+    checkKernel<sse::LongKernel>( text, text + "a" );
+}
+
+BOOST_AUTO_TEST_CASE( Test_query ) {
+    query::Node root;
+    std::string error;
+
+    BOOST_CHECK( !query::parse( "a & (b", root, error ) );
+    BOOST_CHECK( !query::parse( "a & ", root, error ) );
+    BOOST_CHECK( !query::parse( "a b", root, error ) );
+    BOOST_CHECK( !query::parse( "/a", root, error ) );
+    BOOST_CHECK( !query::parse( "\"\"", root, error ) );
+
+    // & binds stronger than |, cheap branches and long literals first
+    BOOST_REQUIRE( query::parse( "/re+gex/ & ab | !\"a \\\"b\\\"\" & abc & a", root, error ) );
+    BOOST_REQUIRE( root.type == query::Node::Type::Or );
+    BOOST_REQUIRE_EQUAL( root.children.size(), 2 );
+
+    const query::Node& left = root.children[1];
+    BOOST_REQUIRE( left.type == query::Node::Type::And );
+    BOOST_CHECK_EQUAL( left.children[0].term, "ab" );
+    BOOST_CHECK_EQUAL( left.children[1].term, "re+gex" );
+    BOOST_CHECK( left.children[1].isRegex );
+
+    const query::Node& right = root.children[0];
+    BOOST_REQUIRE( right.type == query::Node::Type::And );
+    BOOST_REQUIRE( right.children[0].type == query::Node::Type::Not );
+    BOOST_CHECK_EQUAL( right.children[0].children[0].term, "a \"b\"" );
+    BOOST_CHECK_EQUAL( right.children[1].term, "abc" );
+    BOOST_CHECK_EQUAL( right.children[2].term, "a" );
+
+    std::vector<size_t> leaves;
+    query::leaves( root, [&leaves]( const query::Node & leaf ) { leaves.push_back( leaf.leaf ); } );
+    BOOST_CHECK( leaves == std::vector<size_t>( { 2, 3, 4, 1, 0 } ) );
+
+    BOOST_CHECK( !query::matchesEmpty( root ) );
+    BOOST_REQUIRE( query::parse( "a | !(b & c)", root, error ) );
+    BOOST_CHECK( query::matchesEmpty( root ) );
+
+    // ~ binds stronger than &
+    BOOST_CHECK( !query::parse( "a ~ b", root, error ) );
+    BOOST_CHECK( !query::parse( "a ~2 (b | c)", root, error ) );
+    BOOST_REQUIRE( query::parse( "c & \"lock()\" ~5 return", root, error ) );
+    BOOST_REQUIRE( root.type == query::Node::Type::And );
+    BOOST_REQUIRE( root.children[1].type == query::Node::Type::Near );
+    BOOST_CHECK_EQUAL( root.children[1].distance, 5 );
+    BOOST_CHECK_EQUAL( root.children[1].children[0].term, "lock()" );
+    BOOST_CHECK_EQUAL( root.children[1].children[1].term, "return" );
+}
+
+BOOST_AUTO_TEST_CASE( Test_trigram ) {
+    std::string varints;
+
+    for( const uint32_t value : { 0u, 1u, 127u, 128u, 300u, 0xffffffffu } ) { trigram::putVarint( varints, value ); }
+
+    BOOST_CHECK_EQUAL( varints.size(), 1 + 1 + 1 + 2 + 2 + 5 );
+
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>( varints.data() );
+
+    for( const uint32_t value : { 0u, 1u, 127u, 128u, 300u, 0xffffffffu } ) { BOOST_CHECK_EQUAL( trigram::getVarint( ptr ), value ); }
+
+    // ASCII is folded, duplicates are removed
+    BOOST_CHECK( trigram::trigrams( "ab" ).empty() );
+    BOOST_CHECK( trigram::trigrams( "aBcAbc" ) == std::vector<uint32_t>( { 0x616263, 0x626361, 0x636162 } ) );
+
+    // literals, which every match contains
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "basic_\\w+_socket" ), "_socket" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "std::vector<int>\\.size" ), "std::vector<int>.size" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "colou?r" ), "colo" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "ab+cde" ), "cde" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "[abc]defg(hijkl)" ), "defg" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "foo|bar" ), "" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "foo{100}" ), "fo" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "ab{2,3}cdef" ), "cdef" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "x{100}" ), "" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "\\x41bcd" ), "" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "[[:alpha:]]foo" ), "foo" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "[^[:space:]]]bar" ), "]bar" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "[[=a=][.-.]x]foo" ), "foo" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "(?i)foobar" ), "foobar" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "(?:ab)foobar" ), "foobar" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "(?x)xfo o" ), "" );
+    BOOST_CHECK_EQUAL( trigram::requiredLiteral( "foobar(?s:a.b)" ), "" );
+}
+
+BOOST_AUTO_TEST_CASE( Test_fingerprint ) {
+    BOOST_CHECK_EQUAL( fingerprint::words( 0 ), 0 );
+    BOOST_CHECK_EQUAL( fingerprint::words( 1 ), 4 );
+    BOOST_CHECK_EQUAL( fingerprint::words( 100 ), 16 );
+    BOOST_CHECK_EQUAL( fingerprint::words( 10000000 ), fingerprint::MAX_WORDS );
+
+    // empty files contain nothing
+    BOOST_CHECK( !fingerprint::contains( nullptr, 0, 0x616263 ) );
+
+    const std::vector<uint32_t> trigrams = trigram::trigrams( "async_read_some(buffer)" );
+    std::vector<uint64_t> words( fingerprint::words( trigrams.size() ), 0 );
+
+    for( const uint32_t trigram : trigrams ) { fingerprint::add( words.data(), words.size(), trigram ); }
+
+    for( const uint32_t trigram : trigrams ) { BOOST_CHECK( fingerprint::contains( words.data(), words.size(), trigram ) ); }
+
+    size_t hits = 0;
+
+    for( const uint32_t trigram : trigram::trigrams( "zzqqxyz_handler_strand" ) ) {
+        hits += fingerprint::contains( words.data(), words.size(), trigram );
+    }
+
+    BOOST_CHECK_LT( hits, 3 );
+
+    // ~10 bits per trigram give less than 2 % false positives, also for trigrams of letters only
+    const std::string letters = "abcdefghijklmnopqrstuvwxyz";
+    std::mt19937 random( 1 );
+    std::set<uint32_t> added;
+
+    while( added.size() < 100 ) {
+        added.insert( trigram::trigramAt( std::string( { letters[random() % 26], letters[random() % 26], letters[random() % 26] } ).data() ) );
+    }
+
+    words.assign( fingerprint::words( added.size() ), 0 );
+
+    for( const uint32_t trigram : added ) { fingerprint::add( words.data(), words.size(), trigram ); }
+
+    size_t probes = 0;
+    hits = 0;
+
+    for( const char a : letters ) {
+        for( const char b : letters ) {
+            for( const char c : letters ) {
+                const uint32_t trigram = trigram::trigramAt( std::string( { a, b, c } ).data() );
+
+                if( added.count( trigram ) ) { continue; }
+
+                ++probes;
+                hits += fingerprint::contains( words.data(), words.size(), trigram );
+            }
+        }
+    }
+
+    BOOST_CHECK_LT( hits * 1000 / probes, 25 );
+}
+
+BOOST_AUTO_TEST_CASE( Test_streamPrinter ) {
+    SearchOptions opts;
+    std::vector<search::Result> results;
+    std::atomic_bool superseded = {false};
+    const StreamPrinter::OnResult onResult = [&results]( const search::Result & result ) { results.push_back( result ); };
+    StreamPrinter printer( opts, onResult, superseded );
+
+    // two matches in line 2, one in line 4
+    const std::string_view content = "one\ntwo two\nthree\nfour two\n";
+    search::Matches matches = { { 4, 7 }, { 8, 11 }, { 23, 26 } };
+    search::Lines lines( 2 );
+    lines[0].number = 2;
+    lines[0].begin = 4;
+    lines[0].end = 11;
+    lines[1].number = 4;
+    lines[1].begin = 18;
+    lines[1].end = 26;
+
+    printer.collectPrints( toSysString( "file.txt" ), matches, lines, content );
+    printer.printPrints();
+
+    BOOST_REQUIRE_EQUAL( results.size(), 1 );
+    const search::Result& result = results.front();
+    BOOST_CHECK_EQUAL( result.path, "file.txt" );
+    BOOST_CHECK_EQUAL( result.count, 3 );
+    BOOST_CHECK_EQUAL( result.text, "two two\nfour two\n" );
+    BOOST_REQUIRE_EQUAL( result.lines.size(), 2 );
+    BOOST_CHECK_EQUAL( result.lines[1].number, 4 );
+    BOOST_CHECK_EQUAL( result.lines[1].view( result.text ), "four two" );
+    BOOST_REQUIRE_EQUAL( result.matches.size(), 3 );
+
+    for( const search::Match& match : result.matches ) {
+        BOOST_CHECK_EQUAL( std::string( match.begin( result.text ), match.end( result.text ) ), "two" );
+    }
+
+    // a newer query drops the results
+    superseded = true;
+    printer.collectCount( toSysString( "file.txt" ), 3 );
+    printer.printPrints();
+    BOOST_CHECK_EQUAL( results.size(), 1 );
+}
+
+BOOST_AUTO_TEST_CASE( Test_binaryTerms ) {
+    // NULs end strstr and strcasestr, binaries need length aware searches
+    const std::string bytes( "foobar\0\0\0xxFOOBAR\0X\0\0X", 22 );
+    utils::Buffer buffer;
+    memcpy( buffer.grow( bytes.size() ), bytes.data(), bytes.size() );
+    const std::string_view content( buffer.ptr, buffer.size );
+
+    SearchOptions opts;
+    opts.binary = true;
+
+    opts.term = "X";
+    BOOST_CHECK_EQUAL( CaseSensitiveSearcher( opts ).count( content ), 2 );
+
+    search::Matches matches;
+    search::Lines lines;
+    CaseSensitiveSearcher( opts ).search( content, matches, lines );
+    BOOST_REQUIRE_EQUAL( matches.size(), 2 );
+    BOOST_CHECK_EQUAL( matches[1].from, 21 );
+
+    opts.term = std::string( 1, '\0' );
+    BOOST_CHECK_EQUAL( CaseSensitiveSearcher( opts ).count( content ), 6 );
+
+    opts.term = "foobar";
+    opts.ignoreCase = true;
+    BOOST_CHECK_EQUAL( CaseInsensitiveSearcher( opts ).count( content ), 2 );
+    BOOST_CHECK( CaseInsensitiveSearcher( opts ).any( content ) );
+
+    std::string hex;
+    BOOST_CHECK( SearchOptions::fromHex( "00", hex ) );
+    BOOST_CHECK_EQUAL( hex, std::string( 1, '\0' ) );
+    BOOST_CHECK( SearchOptions::fromHex( "de ad 00 ef", hex ) );
+    BOOST_CHECK_EQUAL( hex.size(), 4 );
+    BOOST_CHECK( !SearchOptions::fromHex( " ", hex ) );
+}
+
+BOOST_AUTO_TEST_CASE( Test_regexBudget ) {
+    // a budget must not change the results, also not of matches across 2 kB or lines
+    const std::string content = std::string( 2045, 'x' ) + "needle\nfoo  \n  bar\n";
+
+    SearchOptions opts;
+    opts.isRegex = true;
+
+    for( const size_t timeout : { 0, 1000 } ) {
+        opts.timeout = timeout;
+        opts.regex.assign( "need+le" );
+        BOOST_CHECK_EQUAL( RegexSearcher( opts ).count( content ), 1 );
+        opts.regex.assign( "foo\\s+bar" );
+        BOOST_CHECK_EQUAL( RegexSearcher( opts ).count( content ), 1 );
+        opts.regex.assign( "^\\s*$" );
+        BOOST_CHECK_EQUAL( RegexSearcher( opts ).count( content ), 1 );
+    }
+
+    // catastrophic backtracking stops after the budget
+    opts.timeout = 10;
+    opts.regex.assign( "(a+)+c" );
+    RegexSearcher searcher( opts );
+    BOOST_CHECK_EQUAL( searcher.count( std::string( 100000, 'a' ) ), 0 );
+    BOOST_CHECK( searcher.skipped );
+}
+
+BOOST_AUTO_TEST_CASE( Test_asciiFolding ) {
+    // ASCII terms fold like non ASCII ones in non ASCII files, -i istanbul finds İSTANBUL like -i İstanbul
+    SearchOptions opts;
+    opts.ignoreCase = true;
+    opts.term = "istanbul";
+
+    utf8::Pattern folded;
+    BOOST_REQUIRE( utf8::compile( opts.term, folded ) );
+    BOOST_CHECK( utf8::hasNonAscii( folded ) );
+
+    CaseInsensitiveSearcher searcher( opts, folded );
+    BOOST_CHECK_EQUAL( searcher.count( "İSTANBUL, ISTANBUL, ıstanbul" ), 3 );
+    BOOST_CHECK_EQUAL( searcher.count( "ISTANBUL, istanbul" ), 2 );
+
+    BOOST_REQUIRE( utf8::compile( "foo", folded ) );
+    BOOST_CHECK( !utf8::hasNonAscii( folded ) );
+}
+
+BOOST_AUTO_TEST_CASE( Test_boundsOfLiteralsAndRegexes ) {
+    // -w and -x bound literals and regexes the same way, with non ASCII word chars and \r\n line ends
+    const std::string content = "foo\r\nfoo bar\nxfooy\n\xc3\xa4" "foo\nfoo\xc3\xa4 foo\nfoo";
+
+    for( const bool word : { true, false } ) {
+        SearchOptions opts;
+        opts.term = "foo";
+        opts.wholeWord = word;
+        opts.wholeLine = !word;
+
+        search::Matches literal;
+        search::Matches regex;
+        search::Lines lines;
+        CaseSensitiveSearcher( opts ).search( content, literal, lines );
+
+        opts.isRegex = true;
+        opts.regex.assign( opts.regexTerm() );
+        RegexSearcher( opts ).search( content, regex, lines );
+
+        BOOST_REQUIRE_EQUAL( literal.size(), word ? 4 : 2 );
+        BOOST_REQUIRE_EQUAL( regex.size(), literal.size() );
+
+        for( size_t i = 0; i < literal.size(); ++i ) {
+            BOOST_CHECK_EQUAL( regex[i].from, literal[i].from );
+            BOOST_CHECK_EQUAL( regex[i].to, literal[i].to );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( Test_maxCount ) {
+    // searchers stop at their limit and once the search is cancelled
+    SearchOptions opts;
+    opts.term = "foo";
+    const std::string content = "foo foo\nfoo\nfoo";
+    CaseSensitiveSearcher searcher( opts );
+    searcher.limit = 2;
+    BOOST_CHECK_EQUAL( searcher.count( content ), 2 );
+    BOOST_CHECK( searcher.any( content ) );
+
+    search::Matches matches;
+    search::Lines lines;
+    searcher.search( content, matches, lines );
+    BOOST_CHECK_EQUAL( matches.size(), 2 );
+    BOOST_CHECK_EQUAL( lines.size(), 1 );
+
+    std::atomic_bool cancelled = {true};
+    searcher.limit = 0;
+    searcher.cancelled = &cancelled;
+    BOOST_CHECK_EQUAL( searcher.count( content ), 1 );
+
+    // -m with -c and -l stops the whole search at n matches or files
+    const fs::path dir = fs::temp_directory_path( ) / "test_maxCount";
+    fs::remove_all( dir );
+    BOOST_REQUIRE( fs::create_directories( dir ) );
+
+    for( int i = 0; i < 20; ++i ) {
+        boost::filesystem::ofstream( dir / utils::format( "test%02d.txt", i ) ) << "foo\nbar foo\n";
+    }
+
+    std::mutex m;
+    std::vector<search::Result> results;
+    std::atomic_bool superseded = {false};
+    const StreamPrinter::OnResult onResult = [&m, &results]( const search::Result & result ) {
+        std::unique_lock<std::mutex> lock( m );
+        results.push_back( result );
+    };
+
+    opts.path = dir;
+    opts.noGit = true;
+    opts.maxCount = 3;
+    opts.count = true;
+
+    auto run = [&opts, &results, &onResult, &superseded] {
+        results.clear();
+        SearchController controller( opts, [&opts] { return new CaseSensitiveSearcher( opts ); },
+        [&opts, &onResult, &superseded] { return new StreamPrinter( opts, onResult, superseded ); } );
+        controller.run( nullptr );
+
+        size_t total = 0;
+
+        for( const search::Result& result : results ) { total += result.count; }
+
+        return total;
+    };
+
+    BOOST_CHECK_EQUAL( run(), 3 );
+    BOOST_CHECK_EQUAL( results.size(), 2 );
+
+    opts.count = false;
+    opts.onlyFiles = true;
+    BOOST_CHECK_EQUAL( run(), 3 );
+    BOOST_CHECK_EQUAL( results.size(), 3 );
+
+    fs::remove_all( dir );
+}
+
+BOOST_AUTO_TEST_CASE( Test_cancel ) {
+    // a cancelled pool drains its queued jobs w/out running them, and stays usable for the next search
+    std::atomic_bool cancelled = {false};
+    std::atomic_size_t done = {0};
+    ThreadPool pool( 2 );
+    pool.cancelOn( cancelled );
+
+    for( int i = 0; i < 1000; ++i ) {
+        pool.add( [&cancelled, &done] {
+            if( ++done == 10 ) { cancelled = true; }
+        } );
+    }
+
+    pool.wait();
+    BOOST_CHECK_GE( done, 10 );
+    BOOST_CHECK_LT( done, 1000 );
+
+    std::atomic_bool next = {false};
+    pool.cancelOn( next );
+    pool.add( [&done] { done = 0; } );
+    pool.wait();
+    BOOST_CHECK_EQUAL( done, 0 );
+
+    // the walker stops at the first file after cancel
+    const fs::path dir = fs::temp_directory_path( ) / "test_cancel";
+    fs::remove_all( dir );
+    BOOST_REQUIRE( fs::create_directories( dir ) );
+
+    for( int i = 0; i < 20; ++i ) { boost::filesystem::ofstream( dir / utils::format( "test%02d.txt", i ) ) << "foo"; }
+
+    size_t walked = 0;
+    cancelled = false;
+    utils::recurseDir( dir.native(), [&walked, &cancelled]( const sys_string& ) {
+        ++walked;
+        cancelled = true;
+    }, cancelled );
+
+    BOOST_CHECK_EQUAL( walked, 1 );
+    fs::remove_all( dir );
+}